@@ -0,0 +1,115 @@
+// benchmark of the group indexes on recorded traces: replays the same command files (in the format of tests/in*.txt)
+// through the library with every GroupIndex, and prints the time per command of each index. a checksum of the
+// answers of each replay is printed too, so indexes that answer differently on a trace stand out.
+//
+// usage: ./bench_group_index_traces trace1.txt [trace2.txt ...]
+
+#include "../wet2/library2.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* index_names[] = { "avl", "b+tree", "levels", "skiplist" };
+
+static std::vector<std::string> readTrace(const char* file_name) {
+    std::vector<std::string> commands;
+    FILE* file = fopen(file_name, "r");
+    if (!file) {
+        return commands;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        commands.push_back(line);
+    }
+    fclose(file);
+    return commands;
+}
+
+static bool startsWith(const char* line, const char* command) {
+    return strncmp(line, command, strlen(command)) == 0;
+}
+
+// runs one command, and adds its answer to the checksum
+static void runCommand(void** DS, GroupIndexType group_index, const char* line, unsigned long* checksum) {
+    const char* args = strchr(line, ' ');
+    args = args ? args + 1 : "";
+    int a = 0, b = 0, c = 0, d = 0, lower = 0, higher = 0;
+    double value = 0;
+    long res = 0;
+    if (startsWith(line, "Init")) {
+        sscanf(args, "%d %d", &a, &b);
+        *DS = InitWithGroupIndex(a, b, group_index);
+    }
+    else if (startsWith(line, "MergeGroups")) {
+        sscanf(args, "%d %d", &a, &b);
+        res = MergeGroups(*DS, a, b);
+    }
+    else if (startsWith(line, "AddPlayer")) {
+        sscanf(args, "%d %d %d", &a, &b, &c);
+        res = AddPlayer(*DS, a, b, c);
+    }
+    else if (startsWith(line, "RemovePlayer")) {
+        sscanf(args, "%d", &a);
+        res = RemovePlayer(*DS, a);
+    }
+    else if (startsWith(line, "IncreasePlayerIDLevel")) {
+        sscanf(args, "%d %d", &a, &b);
+        res = IncreasePlayerIDLevel(*DS, a, b);
+    }
+    else if (startsWith(line, "ChangePlayerIDScore")) {
+        sscanf(args, "%d %d", &a, &b);
+        res = ChangePlayerIDScore(*DS, a, b);
+    }
+    else if (startsWith(line, "GetPercentOfPlayersWithScoreInBounds")) {
+        sscanf(args, "%d %d %d %d", &a, &b, &c, &d);
+        res = GetPercentOfPlayersWithScoreInBounds(*DS, a, b, c, d, &value);
+    }
+    else if (startsWith(line, "AverageHighestPlayerLevelByGroup")) {
+        sscanf(args, "%d %d", &a, &b);
+        res = AverageHighestPlayerLevelByGroup(*DS, a, b, &value);
+    }
+    else if (startsWith(line, "GetPlayersBound")) {
+        sscanf(args, "%d %d %d", &a, &b, &c);
+        res = GetPlayersBound(*DS, a, b, c, &lower, &higher);
+    }
+    else if (startsWith(line, "Quit")) {
+        Quit(DS);
+    }
+    *checksum = *checksum * 31 + (unsigned long)(res + 4) + (unsigned long)(value * 1000) + lower * 7 + higher * 13;
+}
+
+static void benchTrace(const char* file_name) {
+    std::vector<std::string> commands = readTrace(file_name);
+    if (commands.empty()) {
+        printf("%-30s cannot read the trace\n", file_name);
+        return;
+    }
+    printf("%-30s %8d", file_name, (int)commands.size());
+    for (int group_index = GROUP_INDEX_AVL_TREE; group_index <= GROUP_INDEX_SKIP_LIST; group_index++) {
+        void* DS = nullptr;
+        unsigned long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& command : commands) {
+            runCommand(&DS, (GroupIndexType)group_index, command.c_str(), &checksum);
+        }
+        auto end = std::chrono::steady_clock::now();
+        Quit(&DS);
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / commands.size();
+        printf(" %10.0f %08lx", ns, checksum & 0xffffffff);
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    printf("%-30s %8s", "trace", "commands");
+    for (const char* name : index_names) {
+        printf(" %10s %8s", name, "checksum");
+    }
+    printf("\n");
+    for (int i = 1; i < argc; i++) {
+        benchTrace(argv[i]);
+    }
+    return 0;
+}
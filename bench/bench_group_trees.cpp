@@ -0,0 +1,102 @@
+// benchmark for the players tree of a group: the RankTree (AVL_TREE) vs the PlayerBTree (B_PLUS_TREE) vs the LevelIndex
+// (LEVEL_INDEX) vs the PlayerSkipList (SKIP_LIST). puts players of num_of_levels distinct levels in one group, then
+// times random queries of each kind on the group (percent of players with a score in a level range, players bounds,
+// average of the highest levels) and score updates through the system manager, with score histograms (scale 200) and
+// with the score index (scale 60000). each tree is timed again with the group frozen (see Group::freeze), once with
+// each FrozenScoreIndex: the "add" column of a frozen row is the time of the freeze per player.
+//
+// usage: ./bench_group_trees [num_of_players] [num_of_queries] [num_of_levels]
+
+#include "../wet2/system_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const char* tree_names[] = { "avl", "b+tree", "levels", "skiplist" };
+static const char* frozen_names[] = { "  frozen", "  wavelet" };
+
+template<typename query_t>
+static double timeQueries(int num_of_queries, query_t query) {
+    srand(3);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_of_queries; i++) {
+        query();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / num_of_queries;
+}
+
+// the system is left allocated, as Quit leaves it
+static void benchTree(GroupTreeType tree_type, int num_of_players, int num_of_levels, int scale,
+                      int num_of_queries) {
+    SystemManager* system = new SystemManager(1, scale, DEFAULT_HIST_THRESHOLD, tree_type);
+    srand(1);
+    auto start = std::chrono::steady_clock::now();
+    for (int id = 1; id <= num_of_players; id++) {
+        system->addNewPlayer(id, 1, 1 + rand() % scale);
+        system->increasePlayerLevel(id, 1 + rand() % num_of_levels);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double build_ns = std::chrono::duration<double, std::nano>(end - start).count() / num_of_players;
+
+    Group* group;
+    system->getGroupPtr(1, &group);
+
+    double percent = 0;
+    int with_score, count, lower_bound, higher_bound;
+    // pass 0 is the live group, pass 1 + i is the group frozen with FrozenScoreIndex i
+    double query_ns[3][3];
+    double freeze_ns[2];
+    for (int frozen = 0; frozen < 3; frozen++) {
+        query_ns[frozen][0] = timeQueries(num_of_queries, [&]() {
+            int lower_level = 1 + rand() % num_of_levels;
+            int higher_level = lower_level + rand() % num_of_levels;
+            group->getPercentOfPlayersWithScoreInRange(lower_level, higher_level, 1 + rand() % scale, &percent,
+                                                       &with_score, &count);
+        });
+        query_ns[frozen][1] = timeQueries(num_of_queries, [&]() {
+            group->calcPlayerBounds(1 + rand() % num_of_players, 1 + rand() % scale, &lower_bound, &higher_bound);
+        });
+        query_ns[frozen][2] = timeQueries(num_of_queries, [&]() {
+            percent += group->calcAverageLeadPlayersLevel(1 + rand() % num_of_players);
+        });
+        if (frozen < 2) {
+            group->thaw();
+            start = std::chrono::steady_clock::now();
+            group->freeze((FrozenScoreIndex)frozen);
+            end = std::chrono::steady_clock::now();
+            freeze_ns[frozen] = std::chrono::duration<double, std::nano>(end - start).count() / num_of_players;
+        }
+    }
+    // the first update thaws the group
+    double update_ns = timeQueries(num_of_queries, [&]() {
+        system->updatePlayerScore(1 + rand() % num_of_players, 1 + rand() % scale);
+    });
+
+    printf("%-8s %10.0f %10.0f %10.0f %10.0f %10.0f\n", tree_names[tree_type], build_ns, query_ns[0][0],
+           query_ns[0][1], query_ns[0][2], update_ns);
+    for (int score_index = FROZEN_SCORE_POSITIONS; score_index <= FROZEN_SCORE_WAVELET; score_index++) {
+        printf("%-8s %10.0f %10.0f %10.0f %10.0f %10s\n", frozen_names[score_index], freeze_ns[score_index],
+               query_ns[1 + score_index][0], query_ns[1 + score_index][1], query_ns[1 + score_index][2], "-");
+    }
+}
+
+static void benchScale(int num_of_players, int num_of_queries, int num_of_levels, int scale) {
+    printf("scale %d, %d players, %d levels (ns per operation)\n", scale, num_of_players, num_of_levels);
+    printf("%-8s %10s %10s %10s %10s %10s\n", "tree", "add", "percent", "bounds", "average", "score");
+    benchTree(AVL_TREE, num_of_players, num_of_levels, scale, num_of_queries);
+    benchTree(B_PLUS_TREE, num_of_players, num_of_levels, scale, num_of_queries);
+    benchTree(LEVEL_INDEX, num_of_players, num_of_levels, scale, num_of_queries);
+    benchTree(SKIP_LIST, num_of_players, num_of_levels, scale, num_of_queries);
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    int num_of_players = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int num_of_queries = (argc > 2) ? atoi(argv[2]) : 200000;
+    int num_of_levels = (argc > 3) ? atoi(argv[3]) : 2000;
+
+    benchScale(num_of_players, num_of_queries, num_of_levels, 200);
+    benchScale(num_of_players, num_of_queries, num_of_levels, 60000);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// microbenchmark for the dense histogram kernels: the scalar loops vs the SIMD kernels this CPU supports,
+// at scales 50, 100 and 200. "rebuild" is the old updateRank pattern (clear, += left, += right) and "fused" is the
+// single-pass sum that replaced it. the second table times the mixed width kernels, for every counter width pair.
+//
+// usage: ./bench_histogram_kernels [iterations]
+
+#include "../wet2/histogram_kernels.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const int scales[] = { 50, 100, 200 };
+
+template<typename func_t>
+static double timeNs(func_t func, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000000;
+    printf("selected kernels: %s\n", hist_kernels.name);
+    printf("%-8s %-6s %8s %8s %8s %8s %8s %8s\n", "kernels", "scale", "add", "sub", "sum", "clear", "rebuild", "fused");
+
+    for (int scale : scales) {
+        int padded_size = histPaddedSize(scale);
+        int* dst = (int*)allocateHistCounters(padded_size, sizeof(int));
+        int* left = (int*)allocateHistCounters(padded_size, sizeof(int));
+        int* right = (int*)allocateHistCounters(padded_size, sizeof(int));
+        for (int i = 0; i < scale; i++) {
+            left[i] = rand() % 100;
+            right[i] = rand() % 100;
+        }
+
+        for (int type = HIST_KERNELS_SCALAR; type < NUM_OF_HIST_KERNELS; type++) {
+            if (!histKernelsSupported((HistKernelsType)type)) {
+                continue;
+            }
+            const HistKernels& kernels = getHistKernels((HistKernelsType)type);
+            double add_ns = timeNs([&]() { kernels.add(dst, left, padded_size); }, iterations);
+            double sub_ns = timeNs([&]() { kernels.sub(dst, left, padded_size); }, iterations);
+            double sum_ns = timeNs([&]() { kernels.sum(dst, left, right, padded_size); }, iterations);
+            double clear_ns = timeNs([&]() { kernels.clear(dst, padded_size); }, iterations);
+            double rebuild_ns = timeNs([&]() {
+                kernels.clear(dst, padded_size);
+                kernels.add(dst, left, padded_size);
+                kernels.add(dst, right, padded_size);
+            }, iterations);
+            double fused_ns = timeNs([&]() { kernels.sum(dst, left, right, padded_size); }, iterations);
+            printf("%-8s %-6d %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", kernels.name, scale, add_ns, sub_ns, sum_ns,
+                   clear_ns, rebuild_ns, fused_ns);
+        }
+
+        freeHistCounters(dst);
+        freeHistCounters(left);
+        freeHistCounters(right);
+    }
+    printf("(ns per call)\n\n");
+
+    // the selected kernels, on counters of every width pair (dst width, src width)
+    const int widths[][2] = { {1, 1}, {2, 1}, {2, 2}, {4, 1}, {4, 2}, {4, 4} };
+    printf("%-8s %-6s %8s %8s\n", "widths", "scale", "add", "sum");
+    for (int scale : scales) {
+        int padded_size = histPaddedSize(scale);
+        for (const int* pair : widths) {
+            void* dst = allocateHistCounters(padded_size, pair[0]);
+            void* src = allocateHistCounters(padded_size, pair[1]);
+            double add_ns = timeNs([&]() { histAddCounters(dst, pair[0], src, pair[1], padded_size); }, iterations);
+            double sum_ns = timeNs([&]() { histSumCounters(dst, pair[0], src, pair[1], src, pair[1], padded_size); },
+                                   iterations);
+            printf("%d<-%-5d %-6d %8.1f %8.1f\n", pair[0], pair[1], scale, add_ns, sum_ns);
+            freeHistCounters(dst);
+            freeHistCounters(src);
+        }
+    }
+    printf("(ns per call)\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+// benchmark for the merge cost model of the rank tree: for a tree of n players and trees of m <= n players, times each
+// merge path (insertion, union, rebuild) and prints the path mergeTreeToMe chose, with score histograms (scale 200)
+// and without them (the per-score trees of the score index).
+// the second part runs random MergeGroups through the library with every group index, and prints how many merges of
+// the group indexes and hash tables took each path.
+//
+// usage: ./bench_merge [n] [num_of_groups]
+
+#include "../wet2/library2.h"
+#include "../wet2/rank_tree.h"
+#include "../wet2/player_rank.h"
+#include "../wet2/count_rank.h"
+#include "../wet2/group_hashtable_val.h"
+#include "../wet2/group_index.h"
+#include "../wet2/dynamic_hash_table.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using std::vector;
+
+static const char* path_names[] = { "insertion", "union", "rebuild" };
+static const char* index_names[] = { "avl", "b+tree", "levels", "skiplist" };
+
+// players with random ids and levels, so the 2 trees interleave
+static vector<Player*> createPlayers(int num_of_players, int scale) {
+    vector<int> ids(num_of_players);
+    for (int i = 0; i < num_of_players; i++) {
+        ids[i] = i + 1;
+    }
+    std::random_shuffle(ids.begin(), ids.end());
+
+    vector<Player*> players(num_of_players);
+    for (int i = 0; i < num_of_players; i++) {
+        players[i] = new Player(ids[i], 0, 1 + rand() % scale);
+        players[i]->increaseLevel(1 + rand() % 100);
+    }
+    return players;
+}
+
+// times one merge of m players into n players. path NUM_OF_MERGE_PATHS is mergeTreeToMe, which picks the path.
+template<typename rank_t>
+static double timeMerge(vector<Player*>& players, int n, int m, int path, int scale, int hist_threshold) {
+    RankTree<Player, rank_t> tree(hist_threshold);
+    RankTree<Player, rank_t> other_tree(hist_threshold);
+    for (int i = 0; i < n + m; i++) {
+        ((i < n) ? tree : other_tree).insert(players[i], scale);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    switch (path) {
+        case MERGE_BY_INSERTION: tree.insertTreeToMe(other_tree); break;
+        case MERGE_BY_UNION: tree.unionTreeToMe(other_tree); break;
+        case MERGE_BY_REBUILD: tree.rebuildTreeToMe(other_tree); break;
+        default: tree.mergeTreeToMe(other_tree); break;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename rank_t>
+static void benchPaths(const char* name, int n, int scale, int hist_threshold) {
+    printf("%s, n = %d\n", name, n);
+    printf("%8s %12s %12s %12s %10s\n", "m", "insertion", "union", "rebuild", "chosen");
+    vector<Player*> players = createPlayers(2 * n, scale);
+
+    for (int m = 1; m <= n; m = (m < 1000) ? m * 10 : m * 2) {
+        double times[NUM_OF_MERGE_PATHS];
+        for (int path = 0; path < NUM_OF_MERGE_PATHS; path++) {
+            times[path] = timeMerge<rank_t>(players, n, m, path, scale, hist_threshold);
+        }
+
+        RankTree<Player, rank_t>::resetMergeCounters();
+        timeMerge<rank_t>(players, n, m, NUM_OF_MERGE_PATHS, scale, hist_threshold);
+        int chosen = 0;
+        while (RankTree<Player, rank_t>::getMergeCounters().merges[chosen] == 0) {
+            chosen++;
+        }
+        printf("%8d %10.3fms %10.3fms %10.3fms %10s\n", m, times[MERGE_BY_INSERTION], times[MERGE_BY_UNION],
+               times[MERGE_BY_REBUILD], path_names[chosen]);
+    }
+
+    for (Player* player : players) {
+        delete player;
+    }
+    printf("\n");
+}
+
+static void printCounters(const char* name, const MergeCounters& counters) {
+    printf("%-12s", name);
+    for (int path = 0; path < NUM_OF_MERGE_PATHS; path++) {
+        printf(" %s %ld", path_names[path], counters.merges[path]);
+    }
+    printf("\n");
+}
+
+// players spread over the groups by a skewed distribution, so the merges have a mix of sizes
+static void benchGroupMerges(int num_of_players, int num_of_groups, GroupIndexType group_index) {
+    void *DS = InitWithGroupIndex(num_of_groups, 200, group_index);
+    for (int id = 1; id <= num_of_players; id++) {
+        int group = 1 + (int)((double)num_of_groups * (rand() % 1000) * (rand() % 1000) / 1000000);
+        AddPlayer(DS, id, group, 1 + rand() % 200);
+        IncreasePlayerIDLevel(DS, id, 1 + rand() % 100);
+    }
+
+    GroupIndex::resetMergeCounters();
+    DynamicHashTable<GroupHashTableVal>::resetMergeCounters();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i < num_of_groups; i++) {
+        MergeGroups(DS, 1 + rand() % num_of_groups, 1 + rand() % num_of_groups);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("%s: %d random merges of %d groups, %d players: %.3fs\n", index_names[group_index], num_of_groups - 1,
+           num_of_groups, num_of_players, std::chrono::duration<double>(end - start).count());
+    printCounters("index", GroupIndex::getMergeCounters((GroupTreeType)group_index));
+    printCounters("hash table", DynamicHashTable<GroupHashTableVal>::getMergeCounters());
+    Quit(&DS);
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 200000;
+    int num_of_groups = (argc > 2) ? atoi(argv[2]) : 10000;
+    srand(1);
+
+    benchPaths<PlayerRank>("score histograms (scale 200)", n, 200, 16);
+    benchPaths<CountRank>("no score histograms", n, 1, INT_MAX);
+    for (int group_index = GROUP_INDEX_AVL_TREE; group_index <= GROUP_INDEX_SKIP_LIST; group_index++) {
+        srand(1);
+        benchGroupMerges(n, num_of_groups, (GroupIndexType)group_index);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+// how many rank tree nodes hold a score histogram with the default hist_threshold (see group.h), and how many of
+// those histograms allocate memory outside the node (see HIST_INLINE_BYTES in histogram.h), for a few scales.
+// the players have random levels and scores, and are inserted one by one, then get random score updates.
+//
+// usage: ./bench_node_histograms [num_of_players] [num_of_updates]
+
+#include "../wet2/rank_tree.h"
+#include "../wet2/player_rank.h"
+#include "../wet2/group.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using std::vector;
+
+typedef RankTree<Player, PlayerRank> PlayerTree;
+typedef RankTreeNode<Player, PlayerRank> PlayerTreeNode;
+
+int main(int argc, char* argv[]) {
+    int num_of_players = (argc > 1) ? atoi(argv[1]) : 100000;
+    int num_of_updates = (argc > 2) ? atoi(argv[2]) : 100000;
+    int scales[] = {10, 16, 32, 50, 64, 100, 200};
+
+    printf("nodes of %d bytes, hist_threshold %d\n", (int)sizeof(PlayerTreeNode), DEFAULT_HIST_THRESHOLD);
+    for (int scale : scales) {
+        PlayerTree tree(DEFAULT_HIST_THRESHOLD);
+        vector<Player*> players;
+        vector<PlayerTreeNode*> nodes;
+        srand(1);
+        for (int i = 1; i <= num_of_players; i++) {
+            Player* player = new Player(i, 1, 1 + rand() % scale);
+            player->increaseLevel(1 + rand() % 1000);
+            PlayerTreeNode* node;
+            tree.insert(player, scale, &node);
+            players.push_back(player);
+            nodes.push_back(node);
+        }
+        for (int i = 0; i < num_of_updates; i++) {
+            int index = rand() % num_of_players;
+            int old_score = players[index]->getScore();
+            players[index]->setScore(1 + rand() % scale);
+            tree.updateScoreAlongPath(nodes[index], old_score, players[index]->getScore());
+        }
+
+        int with_hist = 0, allocating = 0;
+        long allocated_bytes = 0;
+        for (PlayerTreeNode* node = tree.getLeftMostNode(); node != nullptr; node = node->getNext()) {
+            if (node->getRank().hasScoreHist()) {
+                with_hist++;
+                int bytes = node->getRank().getScoreHist().getAllocatedBytes();
+                allocating += (bytes > 0);
+                allocated_bytes += bytes;
+            }
+        }
+        printf("scale %3d: %d of %d nodes hold a histogram, %d of them allocate (%.1f%%), %.1f bytes per node "
+               "allocated for histograms\n", scale, with_hist, num_of_players, allocating,
+               with_hist ? 100.0 * allocating / with_hist : 0.0, (double)allocated_bytes / num_of_players);
+
+        for (Player* player : players) {
+            delete player;
+        }
+    }
+    return 0;
+}
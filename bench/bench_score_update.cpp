@@ -0,0 +1,71 @@
+// benchmark for score updates in the rank tree:
+// full rank recalculation along the path (updateRankAlongPath) vs moving one score count along the path
+// (updateScoreAlongPath).
+//
+// usage: ./bench_score_update [num_of_players] [num_of_updates] [scale]
+
+#include "../wet2/rank_tree.h"
+#include "../wet2/player_rank.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using std::vector;
+
+typedef RankTree<Player, PlayerRank> PlayerTree;
+typedef RankTreeNode<Player, PlayerRank> PlayerTreeNode;
+
+static double timeUpdates(PlayerTree& tree, vector<Player*>& players, vector<PlayerTreeNode*>& nodes,
+                          int num_of_updates, int scale, bool delta_update) {
+    srand(2);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_of_updates; i++) {
+        int index = rand() % (int)players.size();
+        int old_score = players[index]->getScore();
+        int new_score = 1 + rand() % scale;
+        players[index]->setScore(new_score);
+        if (delta_update) {
+            tree.updateScoreAlongPath(nodes[index], old_score, new_score);
+        }
+        else {
+            tree.updateRankAlongPath(nodes[index]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int num_of_players = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int num_of_updates = (argc > 2) ? atoi(argv[2]) : 1000000;
+    int scale = (argc > 3) ? atoi(argv[3]) : 200;
+
+    // build a tree of players with random levels and scores
+    PlayerTree tree;
+    vector<Player*> players;
+    vector<PlayerTreeNode*> nodes;
+    srand(1);
+    for (int i = 1; i <= num_of_players; i++) {
+        Player* player = new Player(i, 1, 1 + rand() % scale);
+        player->increaseLevel(1 + rand() % 1000);
+        tree.insert(player, scale);
+        PlayerTreeNode* node;
+        tree.find(*player, &node);
+        players.push_back(player);
+        nodes.push_back(node);
+    }
+
+    double full_time = timeUpdates(tree, players, nodes, num_of_updates, scale, false);
+    double delta_time = timeUpdates(tree, players, nodes, num_of_updates, scale, true);
+
+    printf("players: %d, updates: %d, scale: %d\n", num_of_players, num_of_updates, scale);
+    printf("updateRankAlongPath:  %.3f sec (%.1f ns/update)\n", full_time, 1e9 * full_time / num_of_updates);
+    printf("updateScoreAlongPath: %.3f sec (%.1f ns/update)\n", delta_time, 1e9 * delta_time / num_of_updates);
+    printf("speedup: %.1fx\n", full_time / delta_time);
+
+    for (int i = 0; i < num_of_players; i++) {
+        delete players[i];
+    }
+    return 0;
+}
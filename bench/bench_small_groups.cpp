@@ -0,0 +1,101 @@
+// benchmark for small groups (see SMALL_GROUP_MAX_SIZE in group.h): a system of many groups with a few players each.
+// prints the memory an idle group allocates, then adds the players and times random level increases, score updates,
+// bounds and average queries through the system manager, with the bytes allocated in all.
+// run_bench.sh builds it twice: as is, and with SMALL_GROUP_MAX_SIZE=0, where every group that has players keeps
+// the full structures.
+//
+// usage: ./bench_small_groups [num_of_groups] [players_per_group] [num_of_operations]
+
+#include "../wet2/system_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static long allocated_bytes = 0;
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    allocated_bytes += size;
+    allocations++;
+    void* ptr = malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+int main(int argc, char** argv) {
+    int num_of_groups = (argc > 1) ? atoi(argv[1]) : 20000;
+    int players_per_group = (argc > 2) ? atoi(argv[2]) : 10;
+    int num_of_operations = (argc > 3) ? atoi(argv[3]) : 2000000;
+    int num_of_players = num_of_groups * players_per_group;
+    int scale = 200;
+
+    // the bytes of the group object itself, and what it allocates
+    allocated_bytes = allocations = 0;
+    {
+        Group idle_group(1, scale);
+        printf("SMALL_GROUP_MAX_SIZE %d: an idle group takes %ld bytes in %ld allocations\n",
+               SMALL_GROUP_MAX_SIZE, (long)sizeof(Group) + allocated_bytes, allocations);
+    }
+
+    allocated_bytes = allocations = 0;
+    SystemManager system(num_of_groups, scale);
+    srand(1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= num_of_players; i++) {
+        system.addNewPlayer(i, 1 + rand() % num_of_groups, 1 + rand() % scale);
+    }
+    auto added = std::chrono::steady_clock::now();
+
+    long checksum = 0;
+    for (int i = 0; i < num_of_operations; i++) {
+        int op = rand() % 4, id = 1 + rand() % num_of_players, group = 1 + rand() % num_of_groups;
+        int m = 1 + rand() % 5, score = 1 + rand() % scale;
+        if (op == 0) {
+            system.increasePlayerLevel(id, m);
+        }
+        else if (op == 1) {
+            system.updatePlayerScore(id, score);
+        }
+        else if (op == 2) {
+            int lower = 0, higher = 0;
+            if (system.getPlayersBoundByGroup(group, m, score, &lower, &higher) == MY_SUCCESS) {
+                checksum += lower + higher;
+            }
+        }
+        else {
+            double average = 0;
+            if (system.calcAverageLeadPlayersLevelByGroup(group, m, &average) == MY_SUCCESS) {
+                checksum += (long)average;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("%d groups, %d players: add %.0f ns per player, %.0f ns per operation, %ld MB in %ld allocations "
+           "(checksum %ld)\n", num_of_groups, num_of_players,
+           std::chrono::duration<double, std::nano>(added - start).count() / num_of_players,
+           std::chrono::duration<double, std::nano>(end - added).count() / num_of_operations,
+           allocated_bytes >> 20, allocations, checksum);
+    return 0;
+}
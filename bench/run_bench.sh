@@ -0,0 +1,27 @@
+rm bench_score_update;
+rm bench_histogram_kernels;
+rm bench_merge;
+rm bench_group_trees;
+rm bench_group_index_traces;
+rm bench_small_groups;
+rm bench_small_groups_off;
+rm bench_node_histograms;
+
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_score_update.cpp ../wet2/player.cpp ../wet2/player_rank.cpp ../wet2/histogram.cpp ../wet2/histogram_kernels.cpp -o bench_score_update
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_histogram_kernels.cpp ../wet2/histogram_kernels.cpp -o bench_histogram_kernels
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_merge.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_merge
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_group_trees.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_group_trees
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_group_index_traces.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_group_index_traces
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_small_groups.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_small_groups
+g++ -std=c++11 -O2 -DNDEBUG -Wall -DSMALL_GROUP_MAX_SIZE=0 bench_small_groups.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_small_groups_off
+g++ -std=c++11 -O2 -DNDEBUG -Wall bench_node_histograms.cpp $(ls ../wet2/*.cpp | grep -v main2.cpp) -o bench_node_histograms
+echo compiled
+
+./bench_score_update 1000000 1000000 200
+./bench_histogram_kernels 2000000
+./bench_merge 200000 10000
+./bench_group_trees 1000000 200000 2000
+./bench_group_index_traces ../tests/in*.txt
+./bench_small_groups 20000 10 2000000
+./bench_small_groups_off 20000 10 2000000
+./bench_node_histograms 100000 100000
@@ -0,0 +1,107 @@
+// checks the frozen groups: 2 systems run the same random updates, and one of them freezes random groups on the way
+// (they thaw by themselves on their next update). after every batch of updates, every group of both systems must
+// answer the same queries (percent, average and bounds) the same way. runs with score histograms and with the score
+// index, with every group index.
+//
+// usage: ./frozen_queries (run by wet2/run_test.sh). fails on the first answer that differs.
+
+#include "../wet2/system_manager.h"
+#include <cstdio>
+#include <cstdlib>
+
+static const int num_of_groups = 6;
+static const int num_of_players = 500;
+static const int num_of_batches = 60;
+static const int batch_size = 80;
+
+static void randomUpdate(SystemManager* system, int op, int id, int group, int score, int level_increase) {
+    if (op < 30) {
+        system->addNewPlayer(id, group, score);
+    }
+    else if (op < 40) {
+        system->removePlayer(id);
+    }
+    else if (op < 70) {
+        system->increasePlayerLevel(id, level_increase);
+    }
+    else if (op < 99) {
+        system->updatePlayerScore(id, score);
+    }
+    else {
+        system->mergeGroups(group, 1 + (group % num_of_groups));
+    }
+}
+
+// asks the same group of both systems the same queries. the scores of the queries may be outside the scale.
+static bool sameAnswers(Group* group, Group* frozen_group, int scale) {
+    for (int i = 0; i < 20; i++) {
+        int lower_level = rand() % 15, higher_level = lower_level + rand() % 15, score = rand() % (scale + 2);
+        int m = 1 + rand() % 60;
+        double percent = 0, frozen_percent = 0;
+        int with_score, count;
+        ReturnValue res = group->getPercentOfPlayersWithScoreInRange(lower_level, higher_level, score, &percent,
+                                                                     &with_score, &count);
+        ReturnValue frozen_res = frozen_group->getPercentOfPlayersWithScoreInRange(lower_level, higher_level, score,
+                                                                                   &frozen_percent, &with_score,
+                                                                                   &count);
+        if (res != frozen_res || (res == MY_SUCCESS && percent != frozen_percent)) {
+            return false;
+        }
+        if (group->calcAverageLeadPlayersLevel(m) != frozen_group->calcAverageLeadPlayersLevel(m)) {
+            return false;
+        }
+        int lower = 0, higher = 0, frozen_lower = 0, frozen_higher = 0;
+        res = group->calcPlayerBounds(m, score, &lower, &higher);
+        frozen_res = frozen_group->calcPlayerBounds(m, score, &frozen_lower, &frozen_higher);
+        if (res != frozen_res || (res == MY_SUCCESS && (lower != frozen_lower || higher != frozen_higher))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkSystems(GroupTreeType tree_type, int scale, FrozenScoreIndex score_index) {
+    SystemManager* system = new SystemManager(num_of_groups, scale, DEFAULT_HIST_THRESHOLD, tree_type);
+    SystemManager* frozen_system = new SystemManager(num_of_groups, scale, DEFAULT_HIST_THRESHOLD, tree_type);
+    srand(scale + tree_type);
+    int frozen_queries = 0;
+    for (int batch = 0; batch < num_of_batches; batch++) {
+        for (int i = 0; i < batch_size; i++) {
+            int op = rand() % 100, id = 1 + rand() % num_of_players, group = 1 + rand() % num_of_groups;
+            int score = 1 + rand() % scale, level_increase = 1 + rand() % 4;
+            randomUpdate(system, op, id, group, score, level_increase);
+            randomUpdate(frozen_system, op, id, group, score, level_increase);
+        }
+        for (int groupID = 0; groupID <= num_of_groups; groupID++) {
+            if (rand() % 2 == 0) {
+                frozen_system->freezeGroup(groupID, score_index);
+            }
+            Group* group;
+            Group* frozen_group;
+            system->getGroupPtr(groupID, &group);
+            frozen_system->getGroupPtr(groupID, &frozen_group);
+            frozen_queries += frozen_group->isFrozen();
+            if (!sameAnswers(group, frozen_group, scale)) {
+                printf("index %d, scale %d, score index %d: group %d differs in batch %d\n", tree_type, scale,
+                       score_index, groupID, batch);
+                return false;
+            }
+        }
+    }
+    printf("index %d, scale %d, score index %d: %d frozen groups queried\n", tree_type, scale, score_index,
+           frozen_queries);
+    return true;
+}
+
+int main() {
+    // 20 keeps score histograms, 1000 uses the score index
+    bool ok = true;
+    for (int tree_type = AVL_TREE; tree_type <= SKIP_LIST && ok; tree_type++) {
+        for (int score_index = FROZEN_SCORE_POSITIONS; score_index <= FROZEN_SCORE_WAVELET && ok; score_index++) {
+            ok = checkSystems((GroupTreeType)tree_type, 20, (FrozenScoreIndex)score_index) &&
+                 checkSystems((GroupTreeType)tree_type, 1000, (FrozenScoreIndex)score_index);
+        }
+    }
+    printf(ok ? "frozen queries: OK\n" : "frozen queries: FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// counts the heap allocations of the read queries (percent, average and bounds), for the histogram backend and the
+// score index backend, with every group index. the first round of queries may allocate, while the scratch
+// accumulators of the groups grow to their final size. repeating the same queries after that must not allocate at all.
+//
+// usage: ./query_allocations (run by wet2/run_test.sh). prints the allocations per round, and fails if the
+// repeated rounds allocated.
+
+#include "../wet2/library2.h"
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <new>
+
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* ptr = malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// the dense histogram counters are allocated with posix_memalign, not new
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    typedef int (*posix_memalign_t)(void**, size_t, size_t);
+    static posix_memalign_t real_posix_memalign = (posix_memalign_t)dlsym(RTLD_NEXT, "posix_memalign");
+    allocations++;
+    return real_posix_memalign(ptr, alignment, size);
+}
+
+static const int num_of_groups = 10;
+static const int num_of_players = 3000;
+static const int num_of_rounds = 4;
+
+// every group gets players, some of them leveled, then half of the groups are merged, so the queries hit merged trees
+static void *buildSystem(int scale, GroupIndexType group_index) {
+    void *DS = InitWithGroupIndex(num_of_groups, scale, group_index);
+    srand(scale);
+    for (int id = 1; id <= num_of_players; id++) {
+        AddPlayer(DS, id, 1 + rand() % num_of_groups, 1 + rand() % scale);
+        if (rand() % 4 != 0) {
+            IncreasePlayerIDLevel(DS, id, 1 + rand() % 50);
+        }
+    }
+    for (int id = 1; id <= num_of_players; id += 7) {
+        ChangePlayerIDScore(DS, id, 1 + rand() % scale);
+    }
+    for (int group = 1; group < num_of_groups; group += 2) {
+        MergeGroups(DS, group, group + 1);
+    }
+    return DS;
+}
+
+// one round of queries, the same on every call. returns the allocations it made.
+static long queryRound(void *DS, int scale) {
+    long allocations_before = allocations;
+    double players = 0, level = 0;
+    int lower_bound = 0, higher_bound = 0;
+    for (int group = 0; group <= num_of_groups; group++) {
+        for (int score = 1; score <= scale; score += 1 + scale / 20) {
+            GetPercentOfPlayersWithScoreInBounds(DS, group, score, 0, 60, &players);
+            GetPercentOfPlayersWithScoreInBounds(DS, group, score, 10, 30, &players);
+            GetPlayersBound(DS, group, score, 100, &lower_bound, &higher_bound);
+        }
+        for (int m = 1; m <= 200; m += 37) {
+            AverageHighestPlayerLevelByGroup(DS, group, m, &level);
+        }
+    }
+    return allocations - allocations_before;
+}
+
+static bool checkScale(int scale, GroupIndexType group_index) {
+    void *DS = buildSystem(scale, group_index);
+    bool ok = true;
+    printf("index %d, scale %d:", group_index, scale);
+    for (int round = 0; round < num_of_rounds; round++) {
+        long round_allocations = queryRound(DS, scale);
+        printf(" %ld", round_allocations);
+        if (round > 0 && round_allocations != 0) {
+            ok = false;
+        }
+    }
+    printf("\n");
+    Quit(&DS);
+    return ok;
+}
+
+int main() {
+    // 200 keeps score histograms, 60000 uses the score index
+    bool ok = true;
+    for (int group_index = GROUP_INDEX_AVL_TREE; group_index <= GROUP_INDEX_SKIP_LIST && ok; group_index++) {
+        ok = checkScale(200, (GroupIndexType)group_index) && checkScale(60000, (GroupIndexType)group_index);
+    }
+    printf(ok ? "query allocations: OK\n" : "query allocations: FAIL\n");
+    return ok ? 0 : 1;
+}
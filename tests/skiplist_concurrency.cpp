@@ -0,0 +1,237 @@
+// checks the readers of a PlayerSkipList against a writer in another thread. the writer inserts, removes, rescores
+// and merges in players (a merge of a big list relinks all the nodes), and records after every update the answers of
+// a fixed set of queries, computed from a sorted copy of the players. every answer a reader got must be the answer
+// of the list as of one of the updates that ran while it asked: select (rank), the sums of the lowest levels, the
+// counts up to a level with a score, the score counts and the lowest and highest players.
+//
+// usage: ./skiplist_concurrency (run by wet2/run_test.sh). build it with -fsanitize=thread to check the races too.
+
+#include "../wet2/player_skiplist.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+static const int scale = 20;
+static const int max_level = 1000;
+static const int num_of_players = 5000;
+static const int num_of_first_players = 2000;
+static const int num_of_updates = 3000;
+static const int num_of_queries = 12;
+static const int num_of_readers = 3;
+static const int max_answers_per_reader = 200000;
+
+struct Query {
+    int kind;       // 0: select, 1: sum of the lowest levels, 2: count up to a level, 3: count a score, 4: lowest and
+                    // highest players
+    int arg;
+    int score;
+};
+
+struct Answer {
+    long value1;
+    long value2;
+
+    bool operator==(const Answer& other_answer) const {
+        return value1 == other_answer.value1 && value2 == other_answer.value2;
+    }
+};
+
+// a query a reader asked while the writer was between the updates first_update and last_update
+struct ReaderAnswer {
+    int query;
+    int first_update;
+    int last_update;
+    Answer answer;
+};
+
+static Query queries[num_of_queries];
+static std::vector<Answer> answers_after_update[num_of_updates + 1];
+static std::atomic<int> updates_done(0);
+
+static long playerID(const Player* player) {
+    return player ? player->getPlayerID() : 0;
+}
+
+static Answer askList(const PlayerSkipList& list, const Query& query) {
+    Answer answer = {0, 0};
+    if (query.kind == 0) {
+        answer.value1 = playerID(list.select(query.arg));
+    }
+    else if (query.kind == 1) {
+        answer.value1 = list.sumOfLowestLevels(query.arg);
+    }
+    else if (query.kind == 2) {
+        int players, players_with_score;
+        list.countUpTo(Player::levelUpperBound(query.arg), query.score, &players, &players_with_score);
+        answer.value1 = players;
+        answer.value2 = players_with_score;
+    }
+    else if (query.kind == 3) {
+        answer.value1 = list.countWithScore(query.score);
+    }
+    else {
+        answer.value1 = playerID(list.getLowestPlayer());
+        answer.value2 = playerID(list.getHighestPlayer());
+    }
+    return answer;
+}
+
+// the answer of a list of the given players, sorted by their tree keys
+static Answer askSorted(const std::vector<Player*>& players, const Query& query) {
+    Answer answer = {0, 0};
+    int size = (int)players.size();
+    if (query.kind == 0) {
+        answer.value1 = (query.arg <= size) ? players[query.arg - 1]->getPlayerID() : 0;
+    }
+    else if (query.kind == 1) {
+        for (int i = 0; i < std::min(query.arg, size); i++) {
+            answer.value1 += players[i]->getLevel();
+        }
+    }
+    else if (query.kind == 2) {
+        for (int i = 0; i < size && players[i]->getLevel() <= query.arg; i++) {
+            answer.value1++;
+            answer.value2 += (players[i]->getScore() == query.score);
+        }
+    }
+    else if (query.kind == 3) {
+        for (Player* player : players) {
+            answer.value1 += (player->getScore() == query.score);
+        }
+    }
+    else if (size > 0) {
+        answer.value1 = players[0]->getPlayerID();
+        answer.value2 = players[size - 1]->getPlayerID();
+    }
+    return answer;
+}
+
+static void recordAnswers(const std::vector<Player*>& players, int update) {
+    for (int i = 0; i < num_of_queries; i++) {
+        answers_after_update[update].push_back(askSorted(players, queries[i]));
+    }
+}
+
+static void askQueries(const PlayerSkipList* list, std::vector<ReaderAnswer>* reader_answers, unsigned int seed) {
+    while (updates_done < num_of_updates) {
+        seed = seed * 1103515245 + 12345;
+        ReaderAnswer reader_answer;
+        reader_answer.query = (int)(seed >> 16) % num_of_queries;
+        reader_answer.first_update = updates_done;
+        reader_answer.answer = askList(*list, queries[reader_answer.query]);
+        reader_answer.last_update = std::min(updates_done + 1, num_of_updates);
+        if ((int)reader_answers->size() < max_answers_per_reader) {
+            reader_answers->push_back(reader_answer);
+        }
+    }
+}
+
+static bool isAnswerOfUpdates(const ReaderAnswer& reader_answer) {
+    for (int update = reader_answer.first_update; update <= reader_answer.last_update; update++) {
+        if (answers_after_update[update][reader_answer.query] == reader_answer.answer) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isBefore(const Player* player1, const Player* player2) {
+    return player1->getTreeKey() < player2->getTreeKey();
+}
+
+static void insertSorted(std::vector<Player*>& players, Player* player) {
+    players.insert(std::upper_bound(players.begin(), players.end(), player, isBefore), player);
+}
+
+// the updates of the writer, on the list and on the sorted players. in_list[i] tells if all_players[i] is in the list.
+static void runWriter(PlayerSkipList* list, std::vector<Player*>& all_players, std::vector<bool>& in_list,
+                      std::vector<Player*>& sorted_players) {
+    srand(11);
+    for (int update = 1; update <= num_of_updates; update++) {
+        int index = rand() % num_of_players;
+        Player* player = all_players[index];
+        int op = rand() % 20;
+        if (op < 7 && !in_list[index]) {
+            list->insert(player);
+            insertSorted(sorted_players, player);
+            in_list[index] = true;
+        }
+        else if (op < 15 && in_list[index]) {
+            list->remove(*player);
+            sorted_players.erase(std::lower_bound(sorted_players.begin(), sorted_players.end(), player, isBefore));
+            in_list[index] = false;
+        }
+        else if (op < 19 && in_list[index]) {
+            int old_score = player->getScore();
+            player->setScore(1 + rand() % scale);
+            list->updateScore(*player, old_score, player->getScore());
+        }
+        else if (op == 19) {
+            // a small list is merged in by insertion, a big one by relinking the nodes of both lists
+            PlayerSkipList other_list(scale, true);
+            int size = (rand() % 2) ? 50 : num_of_players;
+            for (int i = 0; i < size; i++) {
+                int other_index = rand() % num_of_players;
+                if (!in_list[other_index]) {
+                    other_list.insert(all_players[other_index]);
+                    insertSorted(sorted_players, all_players[other_index]);
+                    in_list[other_index] = true;
+                }
+            }
+            list->mergeListToMe(other_list);
+        }
+        recordAnswers(sorted_players, update);
+        updates_done = update;
+    }
+}
+
+int main() {
+    PlayerSkipList list(scale, true);
+    std::vector<Player*> all_players, sorted_players;
+    std::vector<bool> in_list(num_of_players, false);
+    srand(5);
+    for (int id = 1; id <= num_of_players; id++) {
+        Player* player = new Player(id, 1, 1 + rand() % scale);
+        player->increaseLevel(1 + rand() % max_level);
+        all_players.push_back(player);
+        if (id <= num_of_first_players) {
+            list.insert(player);
+            insertSorted(sorted_players, player);
+            in_list[id - 1] = true;
+        }
+    }
+    for (int i = 0; i < num_of_queries; i++) {
+        queries[i].kind = i % 5;
+        queries[i].arg = (queries[i].kind == 2) ? 1 + rand() % max_level : 1 + rand() % num_of_first_players;
+        queries[i].score = 1 + rand() % scale;
+    }
+    recordAnswers(sorted_players, 0);
+
+    std::vector<std::vector<ReaderAnswer>> reader_answers(num_of_readers);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < num_of_readers; i++) {
+        readers.push_back(std::thread(askQueries, &list, &reader_answers[i], 17u * (i + 1)));
+    }
+    runWriter(&list, all_players, in_list, sorted_players);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    int checked = 0, wrong = 0;
+    for (const std::vector<ReaderAnswer>& answers : reader_answers) {
+        for (const ReaderAnswer& reader_answer : answers) {
+            checked++;
+            wrong += !isAnswerOfUpdates(reader_answer);
+        }
+    }
+    list.clearList();
+    for (Player* player : all_players) {
+        delete player;
+    }
+    bool ok = checked > 0 && wrong == 0;
+    printf("skiplist readers: %s\n", ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// checks the group snapshots: a system with snapshots runs random updates (add, remove, level, score and merges), and
+// takes snapshots of random groups on the way. a snapshot must answer the queries (percent, average and bounds) as
+// its group did when it was taken, and must keep answering so while the group keeps changing.
+//
+// usage: ./snapshot_consistency (run by wet2/run_test.sh). fails on the first answer that differs.
+
+#include "../wet2/system_manager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const int num_of_groups = 8;
+static const int scale = 20;
+static const int num_of_players = 400;
+static const int num_of_operations = 6000;
+static const int num_of_snapshots = 30;
+static const int num_of_queries = 20;
+
+// one query on a group, and the answer the group gave when the snapshot was taken
+struct Answer {
+    int kind;
+    int arg1, arg2, score;
+    ReturnValue res;
+    double value;
+    int lower_bound, higher_bound;
+};
+
+struct Snapshot {
+    GroupSnapshot* snapshot;
+    std::vector<Answer> answers;
+};
+
+static void askGroup(Group* group, Answer* answer) {
+    answer->value = 0;
+    answer->lower_bound = answer->higher_bound = 0;
+    if (answer->kind == 0) {
+        int with_score, count;
+        answer->res = group->getPercentOfPlayersWithScoreInRange(answer->arg1, answer->arg2, answer->score,
+                                                                 &answer->value, &with_score, &count);
+    }
+    else if (answer->kind == 1) {
+        answer->value = group->calcAverageLeadPlayersLevel(answer->arg1);
+        answer->res = MY_SUCCESS;
+    }
+    else {
+        answer->res = group->calcPlayerBounds(answer->arg1, answer->score, &answer->lower_bound,
+                                              &answer->higher_bound);
+    }
+}
+
+static void askSnapshot(const GroupSnapshot* snapshot, Answer* answer) {
+    answer->value = 0;
+    answer->lower_bound = answer->higher_bound = 0;
+    if (answer->kind == 0) {
+        answer->res = snapshot->getPercentOfPlayersWithScoreInRange(answer->arg1, answer->arg2, answer->score,
+                                                                    &answer->value);
+    }
+    else if (answer->kind == 1) {
+        answer->value = snapshot->calcAverageLeadPlayersLevel(answer->arg1);
+        answer->res = MY_SUCCESS;
+    }
+    else {
+        answer->res = snapshot->calcPlayerBounds(answer->arg1, answer->score, &answer->lower_bound,
+                                                 &answer->higher_bound);
+    }
+}
+
+static bool sameAnswer(const Answer& answer1, const Answer& answer2) {
+    if (answer1.res != answer2.res) {
+        return false;
+    }
+    if (answer1.res != MY_SUCCESS) {
+        return true;
+    }
+    double diff = answer1.value - answer2.value;
+    return diff < 1e-9 && diff > -1e-9 && answer1.lower_bound == answer2.lower_bound &&
+           answer1.higher_bound == answer2.higher_bound;
+}
+
+static void randomUpdate(SystemManager* system) {
+    int op = rand() % 10;
+    int id = 1 + rand() % num_of_players;
+    if (op < 3) {
+        system->addNewPlayer(id, 1 + rand() % num_of_groups, 1 + rand() % scale);
+    }
+    else if (op < 4) {
+        system->removePlayer(id);
+    }
+    else if (op < 7) {
+        system->increasePlayerLevel(id, 1 + rand() % 5);
+    }
+    else if (op < 9) {
+        system->updatePlayerScore(id, 1 + rand() % scale);
+    }
+    else if (rand() % 20 == 0) {
+        system->mergeGroups(1 + rand() % num_of_groups, 1 + rand() % num_of_groups);
+    }
+}
+
+// takes a snapshot of a random group, and records the answers of the group to random queries
+static bool takeSnapshot(SystemManager* system, Snapshot* snapshot) {
+    int groupID = rand() % (num_of_groups + 1);
+    Group* group;
+    if (system->getGroupPtr(groupID, &group) != MY_SUCCESS ||
+        system->takeGroupSnapshot(groupID, &snapshot->snapshot) != MY_SUCCESS) {
+        return false;
+    }
+    for (int i = 0; i < num_of_queries; i++) {
+        Answer answer;
+        answer.kind = rand() % 3;
+        answer.arg1 = (answer.kind == 0) ? rand() % 20 : 1 + rand() % 40;
+        answer.arg2 = answer.arg1 + rand() % 20;
+        answer.score = 1 + rand() % scale;
+        askGroup(group, &answer);
+        snapshot->answers.push_back(answer);
+    }
+    return true;
+}
+
+static bool checkSnapshot(const Snapshot& snapshot) {
+    for (const Answer& answer : snapshot.answers) {
+        Answer snapshot_answer = answer;
+        askSnapshot(snapshot.snapshot, &snapshot_answer);
+        if (!sameAnswer(answer, snapshot_answer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    SystemManager* system = new SystemManager(num_of_groups, scale, DEFAULT_HIST_THRESHOLD, DEFAULT_GROUP_TREE, true);
+    srand(7);
+    std::vector<Snapshot> snapshots;
+    bool ok = true;
+    for (int i = 1; i <= num_of_operations && ok; i++) {
+        randomUpdate(system);
+        if (i % (num_of_operations / num_of_snapshots) == 0) {
+            Snapshot snapshot;
+            snapshot.snapshot = nullptr;
+            ok = takeSnapshot(system, &snapshot);
+            snapshots.push_back(snapshot);
+        }
+        // every snapshot answers as it did when it was taken, while the system keeps changing
+        for (const Snapshot& snapshot : snapshots) {
+            if (ok && i % 100 == 0) {
+                ok = checkSnapshot(snapshot);
+            }
+        }
+    }
+
+    for (Snapshot& snapshot : snapshots) {
+        delete snapshot.snapshot;
+    }
+    printf("%d snapshots: %s\n", (int)snapshots.size(), ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
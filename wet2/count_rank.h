@@ -0,0 +1,44 @@
+#ifndef WET2_COUNT_RANK_H
+#define WET2_COUNT_RANK_H
+
+#include "player.h"
+
+// the rank of a sub_tree that only counts its players, for trees that need order statistics but no levels or scores
+// (see ScoreIndex). it has the interface of PlayerRank, and never holds a score histogram.
+class CountRank {
+    int node_count;
+
+public:
+    explicit CountRank(int) : node_count(0) {}
+    ~CountRank() = default;
+    void swap(CountRank& other_count_rank) noexcept {
+        int temp = node_count;
+        node_count = other_count_rank.node_count;
+        other_count_rank.node_count = temp;
+    }
+
+    void initializeRank(const Player&) { node_count = 1; }
+    void initializeRank(const Player&, const CountRank& left_rank, const CountRank& right_rank, bool) {
+        node_count = 1 + left_rank.node_count + right_rank.node_count;
+    }
+    void updateScore(int, int) {}
+    void addPlayer(const Player&) { node_count++; }
+    void removePlayer(const Player&) { node_count--; }
+    int getNodeCount() const { return node_count; }
+    CountRank& operator+=(const CountRank& other_count_rank) {
+        node_count += other_count_rank.node_count;
+        return *this;
+    }
+    CountRank& operator-=(const CountRank& other_count_rank) {
+        node_count -= other_count_rank.node_count;
+        return *this;
+    }
+
+    bool hasScoreHist() const { return false; }
+    void createScoreHist(int) {}
+    void dropScoreHist() {}
+    void addPlayerScore(const Player&) {}
+    void removePlayerScore(const Player&) {}
+};
+
+#endif //WET2_COUNT_RANK_H
@@ -29,6 +29,8 @@ private:
     bool isEmptyForInsert(int index);
     void initializeArrays();
     void updateFields(DynamicHashTable* hash_to_copy);
+    void insertAllFrom(DynamicHashTable* other_hash_table);
+    static MergeCounters merge_counters;
 
 public:
     explicit DynamicHashTable(int size = ARRAY_START_SIZE);
@@ -38,10 +40,17 @@ public:
     ReturnValue removeData(data_t data);
     int findIndex(data_t data);
     data_t* getDataPtr(data_t data);
+    int getMaxSize() const { return max_size; }
+    data_t* getDataPtrAt(int index); // for scanning the whole table. nullptr if the index holds no data
     void clearTable();
     void mergeToMe(DynamicHashTable<data_t>* other_hash_table);
+    static const MergeCounters& getMergeCounters() { return merge_counters; }
+    static void resetMergeCounters() { merge_counters = MergeCounters(); }
 };
 
+template<class data_t>
+MergeCounters DynamicHashTable<data_t>::merge_counters = MergeCounters();
+
 
 
 
@@ -139,6 +148,15 @@ data_t *DynamicHashTable<data_t>::getDataPtr(data_t data) {
     return (array_start_ptr + index);
 }
 
+template<class data_t>
+data_t *DynamicHashTable<data_t>::getDataPtrAt(int index) {
+    if (index < 0 || index >= max_size || graveyard[index] != TAKEN) {
+        return nullptr;
+    }
+
+    return (array_start_ptr + index);
+}
+
 template<class data_t>
 void DynamicHashTable<data_t>::rescale(double scale) {
     int new_size = max_size*scale;
@@ -209,17 +227,44 @@ void DynamicHashTable<data_t>::updateFields(DynamicHashTable* hash_to_copy) {
     hash_to_copy->graveyard = nullptr;
 }
 
+template<class data_t>
+void DynamicHashTable<data_t>::insertAllFrom(DynamicHashTable<data_t>* other_hash_table) {
+    for (int i = 0; i < other_hash_table->max_size; i++){
+        if (other_hash_table->graveyard[i] == TAKEN){
+            this->insertData(other_hash_table->array_start_ptr[i]);
+        }
+    }
+}
+
+// inserting the data of other_hash_table one by one rehashes the whole table at every rescale on the way, which costs
+// at least as much as rehashing both tables once. so if the inserts would rescale the table, it is rebuilt at its
+// final size instead, with the data of both tables.
 template<class data_t>
 void DynamicHashTable<data_t>::mergeToMe(DynamicHashTable<data_t>* other_hash_table) {
     if (other_hash_table == nullptr){
         return;
     }
 
-    for (int i = 0; i < other_hash_table->max_size; i++){
-        if (other_hash_table->graveyard[i] == TAKEN){
-            this->insertData(other_hash_table->array_start_ptr[i]);
-        }
+    int merged_size = curr_size + other_hash_table->curr_size;
+    if (merged_size < max_size/2){
+        merge_counters.merges[MERGE_BY_INSERTION]++;
+        insertAllFrom(other_hash_table);
+        return;
     }
+
+    merge_counters.merges[MERGE_BY_REBUILD]++;
+    int new_size = max_size;
+    while (merged_size >= new_size/2){
+        new_size *= UP_SCALE;
+    }
+    DynamicHashTable* new_hash = new DynamicHashTable<data_t>(new_size);
+    if(!new_hash){
+        throw std::bad_alloc();
+    }
+    new_hash->insertAllFrom(this);
+    new_hash->insertAllFrom(other_hash_table);
+    updateFields(new_hash);
+    delete new_hash;
 }
 
 
@@ -0,0 +1,128 @@
+#include "frozen_players.h"
+#include <algorithm>
+#include <new>
+
+FrozenPlayers::FrozenPlayers(Player** players, int size, int scale, FrozenScoreIndex score_index) :
+        size(size), scale(scale), score_offsets(nullptr), score_positions(nullptr), scores(nullptr) {
+    eytzinger_levels = new int[size + 1];
+    eytzinger_positions = new int[size + 1];
+    sorted_levels = new int[size];
+    lowest_levels_sums = new long[size + 1];
+    if (!eytzinger_levels || !eytzinger_positions || !sorted_levels || !lowest_levels_sums) {
+        throw std::bad_alloc();
+    }
+
+    lowest_levels_sums[0] = 0;
+    for (int i = 0; i < size; i++) {
+        sorted_levels[i] = players[i]->getLevel();
+        lowest_levels_sums[i + 1] = lowest_levels_sums[i] + sorted_levels[i];
+    }
+    eytzinger_levels[0] = 0;
+    eytzinger_positions[0] = size;
+    fillEytzinger(0, 1);
+
+    if (score_index == FROZEN_SCORE_POSITIONS) {
+        fillScorePositions(players);
+        return;
+    }
+    int* sorted_scores = new int[size];
+    if (!sorted_scores) {
+        throw std::bad_alloc();
+    }
+    for (int i = 0; i < size; i++) {
+        sorted_scores[i] = players[i]->getScore();
+    }
+    scores = new WaveletMatrix(sorted_scores, size, scale);
+    delete[] sorted_scores;
+    if (!scores) {
+        throw std::bad_alloc();
+    }
+}
+
+FrozenPlayers::~FrozenPlayers() {
+    delete[] eytzinger_levels;
+    delete[] eytzinger_positions;
+    delete[] sorted_levels;
+    delete[] lowest_levels_sums;
+    delete[] score_offsets;
+    delete[] score_positions;
+    delete scores;
+}
+
+void FrozenPlayers::fillScorePositions(Player** players) {
+    score_offsets = new int[scale + 1];
+    score_positions = new int[size];
+    if (!score_offsets || !score_positions) {
+        throw std::bad_alloc();
+    }
+
+    // count the players of each score, then place their positions (in ascending order) after the smaller scores
+    std::fill(score_offsets, score_offsets + scale + 1, 0);
+    for (int i = 0; i < size; i++) {
+        score_offsets[players[i]->getScore()]++;
+    }
+    for (int score = 1; score <= scale; score++) {
+        score_offsets[score] += score_offsets[score - 1];
+    }
+    for (int i = size - 1; i >= 0; i--) {
+        score_positions[--score_offsets[players[i]->getScore()]] = i;
+    }
+    // score_offsets[s] is now the start of score s, which is the end of score s-1
+    for (int score = 0; score < scale; score++) {
+        score_offsets[score] = score_offsets[score + 1];
+    }
+    score_offsets[scale] = size;
+}
+
+// the amount of players with the given score (in the scale) among the first position players
+int FrozenPlayers::countScoreUpTo(int score, int position) const {
+    if (scores) {
+        return scores->rank(score, position);
+    }
+    const int* first = score_positions + score_offsets[score - 1];
+    const int* last = score_positions + score_offsets[score];
+    return std::lower_bound(first, last, position) - first;
+}
+
+// fills the eytzinger subtree of slot with the sorted levels from sorted_position on (an in order walk of the
+// implicit tree). returns the sorted position after the subtree.
+int FrozenPlayers::fillEytzinger(int sorted_position, int slot) {
+    if (slot > size) {
+        return sorted_position;
+    }
+    sorted_position = fillEytzinger(sorted_position, 2 * slot);
+    eytzinger_levels[slot] = sorted_levels[sorted_position];
+    eytzinger_positions[slot] = sorted_position;
+    return fillEytzinger(sorted_position + 1, 2 * slot + 1);
+}
+
+// the amount of players with level <= level: the sorted position of the first level above it.
+// the search goes down the implicit tree without branches, and prefetches the slots 4 levels below (16 ints, one
+// cache line). when it falls off the tree, the slot of the first level above is found by dropping the right turns
+// it took after its last left turn.
+int FrozenPlayers::countUpToLevel(int level) const {
+    unsigned int slot = 1;
+    while (slot <= (unsigned int)size) {
+        __builtin_prefetch(eytzinger_levels + 16 * slot);
+        slot = 2 * slot + (eytzinger_levels[slot] <= level);
+    }
+    slot >>= __builtin_ffs(~slot);
+    return eytzinger_positions[slot];
+}
+
+// a score outside the scale (the percent query doesn't check it) has no players
+void FrozenPlayers::countUpToLevel(int level, int score, int* players, int* players_with_score) const {
+    *players = countUpToLevel(level);
+    if (score < 1 || score > scale) {
+        *players_with_score = 0;
+        return;
+    }
+    *players_with_score = countScoreUpTo(score, *players);
+}
+
+int FrozenPlayers::countWithScore(int score) const {
+    if (score < 1 || score > scale) {
+        return 0;
+    }
+    return scores ? scores->rank(score, size) : score_offsets[score] - score_offsets[score - 1];
+}
@@ -0,0 +1,52 @@
+#ifndef WET2_FROZEN_PLAYERS_H
+#define WET2_FROZEN_PLAYERS_H
+
+#include "player.h"
+#include "wavelet_matrix.h"
+
+// how a frozen group counts the players of a score up to a position:
+// - FROZEN_SCORE_POSITIONS: the sorted positions of the players of each score, and a binary search in them. 32 bits per
+//   player, and an int per score.
+// - FROZEN_SCORE_WAVELET: a WaveletMatrix of the scores, with O(log(scale)) rank steps. about log(scale) bits per
+//   player, but the percent and bounds queries take 2 to 5 times as long (see bench/bench_group_trees.cpp).
+typedef enum {FROZEN_SCORE_POSITIONS, FROZEN_SCORE_WAVELET} FrozenScoreIndex;
+#define DEFAULT_FROZEN_SCORE_INDEX FROZEN_SCORE_POSITIONS
+
+// a read only copy of the players with level > 0 of a frozen group, in flat arrays that answer the counting queries
+// of the group without chasing tree nodes:
+// the levels in Eytzinger (BFS) order, for a branch free binary search that prefetches the nodes it reaches next,
+// the sums of the lowest levels and the levels in sorted order, for the average and the select of the mth player,
+// and the scores in the same order, in the FrozenScoreIndex it was made with.
+// it keeps the scores of the players itself, with or without score histograms in the group. the group drops it on
+// its next update.
+class FrozenPlayers {
+    int size;
+    int scale;
+    int* eytzinger_levels;      // [1..size], eytzinger_levels[0] is unused
+    int* eytzinger_positions;   // the sorted position of each eytzinger slot, and size at slot 0 (none)
+    int* sorted_levels;
+    long* lowest_levels_sums;   // lowest_levels_sums[k] is the sum of the levels of the k lowest players
+    int* score_offsets;         // the positions of the players with score s are score_positions[score_offsets[s-1]..
+    int* score_positions;       // score_offsets[s]), in ascending order. nullptr with FROZEN_SCORE_WAVELET
+    WaveletMatrix* scores;      // nullptr with FROZEN_SCORE_POSITIONS
+
+    int fillEytzinger(int sorted_position, int slot);
+    void fillScorePositions(Player** players);
+    int countScoreUpTo(int score, int position) const;
+
+public:
+    // players are sorted by level
+    FrozenPlayers(Player** players, int size, int scale, FrozenScoreIndex score_index = DEFAULT_FROZEN_SCORE_INDEX);
+    ~FrozenPlayers();
+    FrozenPlayers(const FrozenPlayers& other) = delete;
+    FrozenPlayers& operator=(const FrozenPlayers& other) = delete;
+
+    int getSize() const { return size; }
+    int countUpToLevel(int level) const;
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) const;
+    int countWithScore(int score) const;
+    long sumOfLowestLevels(int k) const { return lowest_levels_sums[k]; }
+    int selectLevel(int k) const { return sorted_levels[k - 1]; }
+};
+
+#endif //WET2_FROZEN_PLAYERS_H
@@ -1,24 +1,35 @@
 #include "group.h"
+#include <climits>
 
-Group::Group(int new_groupID, int scale) {
+// a new group is small, and allocates nothing but its snapshot
+Group::Group(int new_groupID, int scale, int hist_threshold, GroupTreeType tree_type, bool with_snapshots) :
+        small_players(SMALL_GROUP_MAX_SIZE) {
     groupID = new_groupID;
     num_of_players = 0;
     this->scale = scale;
+    this->hist_threshold = hist_threshold;
+    this->tree_type = tree_type;
     highest_level_player = nullptr;
     lowest_level_player = nullptr;
-    players_hash_table = new DynamicHashTable<GroupHashTableVal>();
-    level_0_players_list = new DoublyLinkedList<Player>();
-    level_0_score_hist = new Histogram(scale);
-    non_0_level_players_tree = new RankTree<Player, PlayerRank>();
-    if(!players_hash_table || !level_0_players_list || !level_0_score_hist || !non_0_level_players_tree){
+    players_hash_table = nullptr;
+    level_0_players_list = nullptr;
+    level_0_score_hist = nullptr;
+    players_index = nullptr;
+    score_index = nullptr;
+    snapshot = with_snapshots ? new GroupSnapshot() : nullptr;
+    frozen_players = nullptr;
+    if(with_snapshots && !snapshot){
         throw std::bad_alloc();
     }
 }
 
 Group::~Group() {
     delete level_0_score_hist;
+    delete score_index;
     delete level_0_players_list;
-    delete non_0_level_players_tree;
+    delete players_index;
+    delete snapshot;
+    delete frozen_players;
     delete players_hash_table;
     delete highest_level_player;
     delete lowest_level_player;
@@ -27,14 +38,76 @@ Group::~Group() {
 
 //this function doesn't delete the group, but clears all data structures and sets num_of_players=0
 void Group::resetGroup() {
-    non_0_level_players_tree->clearTree();
-    level_0_score_hist->clearHistogram();
-    players_hash_table->clearTable();
+    thaw();
+    // if we use resetGroup, this means that the group was merged to another group, so the list nodes were moved to the
+    // list of the other group, and the group is small (and empty) again.
+    deleteIndexes();
+    small_players.clear();
+    if (snapshot){
+        snapshot->clearSnapshot();
+    }
     num_of_players = 0;
     highest_level_player = nullptr;
     lowest_level_player = nullptr;
-    // if we use resetGroup, this means that the group was merged to another group, so the list nodes were moved to the
-    // list of the other group, head&tail were set to nullptr.
+}
+
+// allocates the structures of a group that is no longer small, empty
+void Group::createIndexes() {
+    players_hash_table = new DynamicHashTable<GroupHashTableVal>();
+    level_0_players_list = new DoublyLinkedList<Player>();
+    if (scale <= MAX_HIST_SCALE){
+        level_0_score_hist = new Histogram(scale);
+    }
+    else {
+        // the players_index holds no score histograms, the scores are counted by the score_index
+        score_index = new ScoreIndex(scale);
+    }
+    players_index = GroupIndex::create(tree_type, scale, hist_threshold, !score_index);
+    if(!players_hash_table || !level_0_players_list || (!level_0_score_hist && !score_index) || !players_index){
+        throw std::bad_alloc();
+    }
+}
+
+// deletes the structures of the group (but not the nodes of its level 0 list), which makes it small
+void Group::deleteIndexes() {
+    delete players_hash_table;
+    delete level_0_players_list;
+    delete level_0_score_hist;
+    delete players_index;
+    delete score_index;
+    players_hash_table = nullptr;
+    level_0_players_list = nullptr;
+    level_0_score_hist = nullptr;
+    players_index = nullptr;
+    score_index = nullptr;
+}
+
+// moves the players of a small group to new structures
+void Group::promote() {
+    createIndexes();
+    for (int i = 0; i < small_players.getSize(); i++) {
+        addPlayerToIndexes(small_players.getPlayer(i));
+    }
+    small_players.clear();
+}
+
+// moves the players back to the array of a small group, and frees the structures
+void Group::demote() {
+    thaw();
+    while (level_0_players_list->getSize() > 0) {
+        small_players.addPlayer(level_0_players_list->getHead()->getData());
+        level_0_players_list->remove(level_0_players_list->getHead());
+    }
+    int tree_size = players_index->getSize();
+    Player** players = new Player*[tree_size];
+    if (!players) throw std::bad_alloc();
+    int count = 0;
+    players_index->appendPlayersTo(players, &count);
+    for (int i = 0; i < count; i++) {
+        small_players.addPlayer(players[i]);
+    }
+    delete[] players;
+    deleteIndexes();
 }
 
 ReturnValue Group::addPlayer(Player *player){
@@ -43,15 +116,61 @@ ReturnValue Group::addPlayer(Player *player){
         return MY_INVALID_INPUT;
     }
 
-    // create empty hash_table val containing player, and check if player is already in group (exists in hash_table)
-    GroupHashTableVal* temp_hash_val = new GroupHashTableVal(player);
+    // check if player is already in group
     ReturnValue res;
     res = getPlayerPtr(player->getPlayerID(), &player);
     if (res == ELEMENT_EXISTS){
         return res;
     }
+    thaw();
+
+    // a small group that is full moves its players to the structures of a bigger group first
+    if (isSmall() && num_of_players >= SMALL_GROUP_MAX_SIZE){
+        promote();
+    }
+    if (isSmall()){
+        small_players.addPlayer(player);
+    }
+    else {
+        res = addPlayerToIndexes(player);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+    }
+    if (snapshot){
+        res = snapshot->addPlayer(*player);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+    }
+
+    // update highest and lowest players ptr
+    if (highest_level_player == nullptr) {
+        highest_level_player = player;
+    }
+    else if(highest_level_player->getLevel() < player->getLevel()){
+        highest_level_player = player;
+    }
+    if (lowest_level_player == nullptr) {
+        lowest_level_player = player;
+    }
+    else if ( player->getLevel() < lowest_level_player->getLevel()) {
+        lowest_level_player = player;
+    }
+
+    // +1 to num of players in group
+    num_of_players++;
+
+    return MY_SUCCESS;
+}
+
+// adds the player to the hash_table, and to the level_0 list or the players_index (and to the score_index) of a group
+// that isn't small
+ReturnValue Group::addPlayerToIndexes(Player* player){
+    // create hash_table val containing player
+    GroupHashTableVal* temp_hash_val = new GroupHashTableVal(player);
+    ReturnValue res;
 
-    // player doesn't exist.
     // check if player added is new (level==0) or after levelIncrease (level > 0)
     if(player->getLevel() == 0){ // player is new (level==0)
         // insert player to level_0_linked_list
@@ -73,29 +192,18 @@ ReturnValue Group::addPlayer(Player *player){
         }
 
         // update the level_0_histogram
-        level_0_score_hist->increaseElement(player->getScore()-1);
+        if (!score_index){
+            level_0_score_hist->increaseElement(player->getScore()-1);
+        }
     }
     else { // player is after level increase (level > 0)
-        // insert player to tree
-        res = non_0_level_players_tree->insert(player, scale);
+        // insert player to the players_index, which may keep its handle of the player in temp_hash_val
+        temp_hash_val->setListNode(nullptr);
+        res = players_index->addPlayer(player, temp_hash_val);
         if (res != MY_SUCCESS){
             return res;
         }
 
-        // player was added to tree.
-        // create new PlayerRank for find function, and find the tree node with player
-        RankTreeNode<Player, PlayerRank>* temp_tree_node;
-        res = non_0_level_players_tree->find(*player, &temp_tree_node);
-        if (res != ELEMENT_EXISTS){
-            return MY_FAILURE;
-        }
-
-        // set tree_node ptr in temp_hash_val to found tree_node ptr
-        temp_hash_val->setTreeNode(temp_tree_node);
-
-        // set the list_node_ptr in temp_hash_val to nullptr
-        temp_hash_val->setListNode(nullptr);
-
         // insert the updated temp_hash_val to hash_table
         res = players_hash_table->insertData(*temp_hash_val);
         if (res != MY_SUCCESS){
@@ -103,23 +211,10 @@ ReturnValue Group::addPlayer(Player *player){
         }
     }
 
-    // update highest and lowest players ptr
-    if (highest_level_player == nullptr) {
-        highest_level_player = player;
-    }
-    else if(highest_level_player->getLevel() < player->getLevel()){
-        highest_level_player = player;
-    }
-    if (lowest_level_player == nullptr) {
-        lowest_level_player = player;
+    // index the player by its score
+    if (score_index){
+        return score_index->addPlayer(player);
     }
-    else if ( player->getLevel() < lowest_level_player->getLevel()) {
-        lowest_level_player = player;
-    }
-
-    // +1 to num of players in group
-    num_of_players++;
-
     return MY_SUCCESS;
 }
 
@@ -129,16 +224,34 @@ ReturnValue Group::removePlayer(Player *player){
         return MY_INVALID_INPUT;
     }
 
+    if (isSmall()){
+        int index;
+        ReturnValue res = findSmallPlayer(player->getPlayerID(), &index);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+        small_players.removePlayer(index);
+        if (snapshot){
+            snapshot->removePlayer(*player);
+        }
+        num_of_players--;
+        updateHighestLowestPlayers();
+        return MY_SUCCESS;
+    }
+
     // create hash_table val for given player, and check if it exists in hash_table
     GroupHashTableVal* temp_val;
     ReturnValue res = getPlayerArrayNode(player->getPlayerID(), &temp_val);
     if (res == ELEMENT_DOES_NOT_EXIST){
         return res;
     }
+    thaw();
 
     if(player->getLevel() == 0){ //player is in linked list.
         // update histogram (-1 in the index of the player score (player_score-1))
-        level_0_score_hist->decreaseElement(player->getScore()-1);
+        if (!score_index){
+            level_0_score_hist->decreaseElement(player->getScore()-1);
+        }
 
         // remove list_node from list.
         res = level_0_players_list->remove(temp_val->getListNode());
@@ -146,19 +259,28 @@ ReturnValue Group::removePlayer(Player *player){
             return res;
         }
     }
-    else{ //player is in rank tree.
-        // remove player from tree.
-        res = non_0_level_players_tree->remove(*player);
+    else{ //player is in the players_index.
+        // remove player from the players_index.
+        res = players_index->removePlayer(*player, temp_val);
         if (res != MY_SUCCESS){
             return res;
         }
     }
+    if (score_index){
+        score_index->removePlayer(*player);
+    }
+    if (snapshot){
+        snapshot->removePlayer(*player);
+    }
 
     // update hash_table after removal (mark as freed in graveyard)
     players_hash_table->removeData(*temp_val);
 
-    // decrease num of players in group
+    // decrease num of players in group, and go back to a small group once there are few enough players
     num_of_players--;
+    if (num_of_players <= SMALL_GROUP_MIN_SIZE){
+        demote();
+    }
 
     // update the highest_level_player and lowest_level_player in group
     updateHighestLowestPlayers();
@@ -176,6 +298,11 @@ ReturnValue Group::getPlayerArrayNode(int player_id, GroupHashTableVal** hash_ta
         return ELEMENT_DOES_NOT_EXIST;
     }
 
+    // a small group keeps no hash_table vals (see findSmallPlayer)
+    if (isSmall()){
+        return MY_FAILURE;
+    }
+
     // create dummy player with the correct playerID, and dummy hashtable node to search in the hashtable
     Player dummy_player = Player(player_id, groupID, 0);
 
@@ -191,7 +318,29 @@ ReturnValue Group::getPlayerArrayNode(int player_id, GroupHashTableVal** hash_ta
     return MY_SUCCESS;
 }
 
+// the index of the player in the array of a small group. returns what getPlayerArrayNode returns.
+ReturnValue Group::findSmallPlayer(int player_id, int* index) {
+    if (player_id <= 0){
+        return MY_INVALID_INPUT;
+    }
+    if (num_of_players == 0){
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+    *index = small_players.find(player_id);
+    return (*index < 0) ? MY_FAILURE : MY_SUCCESS;
+}
+
 ReturnValue Group::getPlayerPtr(int player_id, Player** player){
+    if (isSmall()){
+        int index;
+        ReturnValue res = findSmallPlayer(player_id, &index);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+        *player = small_players.getPlayer(index);
+        return ELEMENT_EXISTS;
+    }
+
     // create empty hash table node and find player node in array
     GroupHashTableVal* temp_val;
     ReturnValue res = getPlayerArrayNode(player_id, &temp_val);
@@ -205,19 +354,44 @@ ReturnValue Group::getPlayerPtr(int player_id, Player** player){
     return ELEMENT_EXISTS;
 }
 
+// the level of player should already be increased by level_increase (the player object is shared by group 0 and by
+// the group of the player, so it is increased once, before both groups are updated)
 ReturnValue Group::increasePlayerLevel(Player *player, int level_increase) {
     // check input
     if (player == nullptr || level_increase <= 0){
         return MY_INVALID_INPUT;
     }
 
+    if (isSmall()){
+        int index;
+        ReturnValue res = findSmallPlayer(player->getPlayerID(), &index);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+        if (snapshot){
+            res = snapshot->updatePlayerLevel(*player, player->getLevel() - level_increase);
+            if (res != MY_SUCCESS){
+                return res;
+            }
+        }
+        small_players.updatePlayerLevel(index);
+        updateHighestLowestPlayers();
+        return MY_SUCCESS;
+    }
+
     // create empty hash_table_val, and find the player_val in the hash_table
     GroupHashTableVal* temp_val;
     ReturnValue res = getPlayerArrayNode(player->getPlayerID(), &temp_val);
     if (res != MY_SUCCESS){
         return res;
     }
-
+    thaw();
+    if (snapshot){
+        res = snapshot->updatePlayerLevel(*player, player->getLevel() - level_increase);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+    }
 
     // if player had level=0, it was in the linked list.
     // need to:
@@ -230,34 +404,35 @@ ReturnValue Group::increasePlayerLevel(Player *player, int level_increase) {
         DoublyLinkedListNode<Player>* list_node_to_remove = temp_val->getListNode();
         level_0_players_list->remove(list_node_to_remove);
         temp_val->setNullListNode();
-        level_0_score_hist->decreaseElement(temp_val->getScore()-1); // score is between 1 and scale, but hist is between 0 and scale-1
-        res = non_0_level_players_tree->insert(player, scale);
+        if (score_index){
+            score_index->removePlayer(Player(player->getPlayerID(), player->getGroupID(), player->getScore()));
+            score_index->addPlayer(player);
+        }
+        else {
+            level_0_score_hist->decreaseElement(temp_val->getScore()-1); // score is between 1 and scale, but hist is between 0 and scale-1
+        }
+        res = players_index->addPlayer(player, temp_val);
         if (res != MY_SUCCESS){
             return res;
         }
-        RankTreeNode<Player, PlayerRank>* temp_tree_node;
-        non_0_level_players_tree->find(*player, &temp_tree_node);
-        temp_val->setTreeNode(temp_tree_node);
         updateHighestLowestPlayers();
         return MY_SUCCESS;
     }
 
-    // if player had level>0, it was in the tree.
+    // if player had level>0, it was in the players_index.
     // need to:
     // increase it's level
-    // remove the tree_node with this player
-    // insert new node to tree with new level (tree is sorted by level, so will be inserted in new place)
+    // move the player to its new place in the players_index (it is sorted by level)
     temp_val->increaseLevel(level_increase);
     Player dummy_player = Player(player->getPlayerID(), player->getGroupID(), player->getScore());
     dummy_player.increaseLevel(player->getLevel()-level_increase);
-    res = non_0_level_players_tree->remove(dummy_player);
+    res = players_index->updatePlayerLevel(player, dummy_player, temp_val);
     if (res != MY_SUCCESS){
         return res;
     }
-
-    res = non_0_level_players_tree->insert(player, scale);
-    if (res != MY_SUCCESS){
-        return res;
+    if (score_index){
+        score_index->removePlayer(dummy_player);
+        score_index->addPlayer(player);
     }
     updateHighestLowestPlayers();
     return MY_SUCCESS;
@@ -265,22 +440,49 @@ ReturnValue Group::increasePlayerLevel(Player *player, int level_increase) {
 
 ReturnValue Group::updatePlayerScore(Player *player, int new_score, int old_score) {
     // check input
-    if (player == nullptr || new_score <= 0 || new_score > level_0_score_hist->size) {
+    if (player == nullptr || new_score <= 0 || new_score > scale) {
         return MY_INVALID_INPUT;
     }
 
+    if (isSmall()){
+        int index;
+        ReturnValue res = findSmallPlayer(player->getPlayerID(), &index);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+        if (snapshot){
+            res = snapshot->updatePlayerScore(*player, old_score);
+            if (res != MY_SUCCESS){
+                return res;
+            }
+        }
+        small_players.updatePlayerScore(index, new_score);
+        return MY_SUCCESS;
+    }
+
     // create empty hash_table val, and find the player_val in the hash_table
     GroupHashTableVal* temp_val;
     ReturnValue res = getPlayerArrayNode(player->getPlayerID(), &temp_val);
     if (res != MY_SUCCESS){
         return res;
     }
+    thaw();
+    if (snapshot){
+        res = snapshot->updatePlayerScore(*player, old_score);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+    }
 
     // if level=0, player is in linked list.
     // need to:
     // update histogram (-1 in the index of the old player score (player_score-1))
     // update player to the new score
     // update histogram (+1 in the index of the new player score (player_score-1))
+    if (score_index){
+        temp_val->updateScore(new_score);
+        return score_index->updatePlayerScore(player, old_score);
+    }
     if (temp_val->getLevel() == 0){
         level_0_score_hist->decreaseElement(old_score-1);
         temp_val->updateScore(new_score);
@@ -288,15 +490,13 @@ ReturnValue Group::updatePlayerScore(Player *player, int new_score, int old_scor
         return MY_SUCCESS;
     }
 
-    // if level>0, player is in rank tree.
+    // if level>0, player is in the players_index.
     // need to:
     // update player to the new score
-    // update the rank (which includes score_hist) in tree, starting with the players' tree_node, and up to the root
+    // move the player from old_score to new_score in the score histograms of the players_index
     if (temp_val->getLevel() > 0){
         temp_val->updateScore(new_score);
-        RankTreeNode<Player, PlayerRank>* tree_node = (*temp_val).getTreeNode();
-        non_0_level_players_tree->updateRankAlongPath(tree_node);
-        return MY_SUCCESS;
+        return players_index->updatePlayerScore(*player, temp_val, old_score, new_score);
     }
 
     return MY_FAILURE;
@@ -317,6 +517,17 @@ ReturnValue Group::getPercentOfPlayersWithScoreInRange(int lowerLevel, int highe
         return MY_FAILURE;
     }
 
+    // a small group counts the players in the range in its array
+    if (isSmall()) {
+        small_players.countInLevelRange(lowerLevel, higherLevel, score, players_count, players_with_score);
+        if(*players_count == 0){
+            *percent = -1;
+            return MY_FAILURE;
+        }
+        *percent = 100*((double)*players_with_score/(double)*players_count);
+        return MY_SUCCESS;
+    }
+
     // calculate how many players are in the range using the rank
     *players_count = 0;
     *players_with_score = 0;
@@ -326,33 +537,25 @@ ReturnValue Group::getPercentOfPlayersWithScoreInRange(int lowerLevel, int highe
     // if 0 is included in range (list_included) get num of players with level 0
     if (list_included) {
         *players_count += level_0_players_list->getSize();
-        *players_with_score += level_0_score_hist->getVal(score-1);
-    }
-
-    // if tree is included (levels 1 and up are in range)
-    if (tree_included) {
-        RankTreeNode<Player, PlayerRank> *highest_node = getHighestLevelNode(higherLevel,
-                                                                             non_0_level_players_tree->begin().getPtr());
-        RankTreeNode<Player, PlayerRank> *lowest_node = getLowestLevelNode(lowerLevel,
-                                                                           non_0_level_players_tree->begin().getPtr());
-        if (highest_node == nullptr || lowest_node == nullptr) {
-            *players_count += 0;
-            *players_with_score += 0;
+        if (score_index){
+            *players_with_score += score_index->countPlayersWithScore(score, 0, 0);
         }
         else {
-            // in Rank = score_hist of right_node - score_hist of left node + score of left node itself
-            // in sum of nodes = sum of levels of right node - sum of levels of left node + 1
-            PlayerRank highest_rank = calcRankUptoNodeWrapper(highest_node);
-            PlayerRank lowest_rank = calcRankUptoNodeWrapper(lowest_node);
-            highest_rank -= lowest_rank;
-            *players_count += highest_rank.getNodeCount() + 1;
-            *players_with_score += highest_rank.getScoreHist().getVal(score - 1);
-
-            if (lowest_node->getData()->getScore() == score) {
-                *players_with_score += 1;
-            }
+            *players_with_score += level_0_score_hist->getVal(score-1);
         }
     }
+
+    // if tree is included (levels 1 and up are in range), the players in range are the players up to higherLevel,
+    // minus the players below lowerLevel
+    if (tree_included) {
+        int upto_higher_level, upto_higher_level_with_score;
+        int below_lower_level, below_lower_level_with_score;
+        countTreePlayersUptoLevel(higherLevel, score, &upto_higher_level, &upto_higher_level_with_score);
+        countTreePlayersUptoLevel((lowerLevel > 0) ? lowerLevel - 1 : 0, score, &below_lower_level,
+                                  &below_lower_level_with_score);
+        *players_count += upto_higher_level - below_lower_level;
+        *players_with_score += upto_higher_level_with_score - below_lower_level_with_score;
+    }
     if(*players_count == 0){
         *percent = -1;
         return MY_FAILURE;
@@ -368,9 +571,14 @@ void Group::updateHighestLowestPlayers() {
         highest_level_player = nullptr;
         lowest_level_player= nullptr;
     }
+    // a small group keeps its players sorted by level
+    else if (isSmall()) {
+        lowest_level_player = small_players.getLowestPlayer();
+        highest_level_player = small_players.getHighestPlayer();
+    }
     // if there are players in the group, and tree size is 0, then all players are in the list.
     // get highest and lowest from the list
-    else if ( non_0_level_players_tree->getSize() == 0) {
+    else if (players_index->getSize() == 0) {
         // get the tail - the 1st player inserted to list (players are inserted to head of list)
         // if there is a player, this will be the new lowest_level_player
         highest_level_player = level_0_players_list->getTail()->getData();
@@ -378,14 +586,14 @@ void Group::updateHighestLowestPlayers() {
     }
     // if there are players in the group, and list size is 0, then all players are in the tree.
     else if (level_0_players_list->getSize() == 0) {
-        lowest_level_player = non_0_level_players_tree->getLeftMostNode()->getData();
-        highest_level_player = non_0_level_players_tree->getRightMostNode()->getData();
+        lowest_level_player = players_index->getLowestPlayer();
+        highest_level_player = players_index->getHighestPlayer();
     }
     // if there are players in the group, and both list size and tree size are not 0, then highest will be
     // from tree and lowest will be from list
     else {
         lowest_level_player = level_0_players_list->getTail()->getData();
-        highest_level_player = non_0_level_players_tree->getRightMostNode()->getData();
+        highest_level_player = players_index->getHighestPlayer();
     }
 }
 
@@ -395,183 +603,76 @@ double Group::calcAverageLeadPlayersLevel(int m) {
         // not enough players in group
         return -1;
     }
+    if (isSmall()) {
+        return ((double)small_players.sumOfHighestLevels(m)/(double)m);
+    }
 
     // m is bigger/equal to amount of players in group
     // check amount of players in tree. if m is bigger, level_0_list is included
-    bool list_included = (non_0_level_players_tree->getSize() <= m);
+    bool list_included = (players_index->getSize() <= m);
     double tot_level_sum = 0;
 
     // if list is included, we need to get ALL the players from the tree, and the extra from the list
     if (list_included) {
-        if (non_0_level_players_tree->getSize() != 0){
-            RankTreeIterator<Player, PlayerRank> iter = non_0_level_players_tree->begin();
-            tot_level_sum += iter.getPtr()->getRank().getSumOfLevels();
-        }
+        tot_level_sum += players_index->getSumOfLevels();
 
         // total level count is (0 + sum_of_levels of root in tree) divided by m
         return (tot_level_sum/(double)m);
     }
 
     // if list is not included, all m lead players are from tree.
-    // get the tree_node of the mth lead player (m from top)
-    RankTreeNode<Player, PlayerRank>* mth_node = findMthPlayerTreeNodeWrapper(m);
-    RankTreeNode<Player, PlayerRank>* right_most_node = non_0_level_players_tree->getRightMostNode();
-
-    // calc the sum_of_levels of both nodes
-    PlayerRank right_rank = calcRankUptoNodeWrapper(right_most_node);
-    PlayerRank left_rank = calcRankUptoNodeWrapper(mth_node);
-
-    right_rank -= left_rank;
-    tot_level_sum = right_rank.getSumOfLevels() + mth_node->getData()->getLevel();
+    // their levels are the sum of all levels in the tree, minus the levels of the (tree size - m) lowest players.
+    tot_level_sum = players_index->getSumOfLevels() - sumTreeLowestLevels(players_index->getSize() - m);
     return (tot_level_sum/(double)m);
 }
 
-RankTreeNode<Player, PlayerRank> *Group::getHighestLevelNode(int higher_bound, RankTreeNode<Player, PlayerRank> *node) {
-    if (node == nullptr) {
-        return node;
-    }
-
-    if (node->getData()->getLevel() <= higher_bound) {
-        RankTreeNode<Player, PlayerRank>* temp_node = node;
-        temp_node = getHighestLevelNode(higher_bound, temp_node->getRight());
-        if (temp_node == nullptr) {
-            return node;
-        }
-        return temp_node;
-    }
-    else {
-        return getHighestLevelNode(higher_bound, node->getLeft());
-    }
-}
-
-RankTreeNode<Player, PlayerRank> *Group::getLowestLevelNode(int lower_bound, RankTreeNode<Player, PlayerRank> *node) {
-    if (node == nullptr) {
-        return node;
-    }
-
-    if (node->getData()->getLevel() >= lower_bound) {
-        RankTreeNode<Player, PlayerRank>* temp_node = node;
-        temp_node = getLowestLevelNode(lower_bound, temp_node->getLeft());
-        if (temp_node == nullptr) {
-            return node;
-        }
-        return temp_node;
-    }
-    else {
-        return getLowestLevelNode(lower_bound, node->getRight());
+// counts the players in the tree with level <= level, and how many of them have the given score
+void Group::countTreePlayersUptoLevel(int level, int score, int* players, int* players_with_score) {
+    if (level <= 0) {
+        *players = 0;
+        *players_with_score = 0;
+        return;
     }
-}
 
-PlayerRank Group::calcRankUptoNodeWrapper(RankTreeNode<Player, PlayerRank> *target_node) {
-    PlayerRank rank_tot = PlayerRank(level_0_score_hist->size);
-    RankTreeIterator<Player, PlayerRank> iter = non_0_level_players_tree->begin();
-    if (*(iter.getPtr()->getData()) == *(target_node->getData())) {
-        PlayerRank other_rank = iter.getPtr()->getRank();
-        rank_tot += other_rank;
-        if (!iter.checkNullRight()){
-            iter.goRight();
-            other_rank = iter.getPtr()->getRank();
-            rank_tot -= other_rank;
-        }
-    }
-    else if (*(iter.getPtr()->getData()) < *(target_node->getData())) {
-        calcRankUptoNode(LEFT, target_node, &iter, &rank_tot);
-    }
-    else{
-        calcRankUptoNode(NO, target_node, &iter, &rank_tot);
-    }
-    return rank_tot;
-}
-
-void Group::calcRankUptoNode(CROSSED crossed, RankTreeNode<Player, PlayerRank> *target_node,
-                                   RankTreeIterator<Player, PlayerRank> *iter, PlayerRank* rank_tot) {
-    if(iter->getPtr() == nullptr){
+    if (frozen_players) {
+        frozen_players->countUpToLevel(level, score, players, players_with_score);
         return;
     }
-    if(crossed != NO){
-        if(crossed == RIGHT){
-            PlayerRank other_rank = iter->getPtr()->getRank();
-            rank_tot->operator-=(other_rank);
-        }
-        else{
-            PlayerRank other_rank = iter->getPtr()->getRank();
-            rank_tot->operator+=(other_rank);
-        }
-    }
 
-    if(iter->getPtr() == target_node) {
-        if(!iter->checkNullRight()){
-            iter->goRight();
-            PlayerRank other_rank = iter->getPtr()->getRank();
-            rank_tot->operator-=(other_rank);
-        }
+    // with a score_index, the players_index counts only the players
+    if (score_index) {
+        players_index->countUpToLevel(level, score, players, nullptr);
+        *players_with_score = score_index->countPlayersWithScore(score, 1, level);
         return;
     }
+    players_index->countUpToLevel(level, score, players, players_with_score);
+}
 
-    crossed = NO;
-    if (*(iter->getPtr()->getData()) < *(target_node->getData())) {
-        iter->goRight();
-        if(iter->getPtr() == nullptr){
-            return;
-        }
-        if (*(iter->getPtr()->getData()) > *(target_node->getData())) {
-            crossed = RIGHT;
-        }
+// counts the players in the tree with the given score
+int Group::countTreePlayersWithScore(int score) {
+    if (frozen_players) {
+        return frozen_players->countWithScore(score);
     }
-    else {
-        iter->goLeft();
-        if(iter->getPtr() == nullptr){
-            return;
-        }
-        if (*(iter->getPtr()->getData()) < *(target_node->getData()) || *(iter->getPtr()->getData()) == *(target_node->getData()) ) {
-            crossed = LEFT;
-        }
+    if (score_index) {
+        return score_index->countPlayersWithScore(score, 1, INT_MAX);
     }
-    calcRankUptoNode(crossed, target_node, iter, rank_tot);
+    return players_index->countWithScore(score);
 }
 
-RankTreeNode<Player, PlayerRank>* Group::findMthPlayerTreeNodeWrapper(int m) {
-    RankTreeIterator<Player, PlayerRank> iter = non_0_level_players_tree->begin();
-    if (iter.getPtr() == nullptr) {
-        return nullptr;
+// the sum of the levels of the k lowest players in the tree
+long Group::sumTreeLowestLevels(int k) {
+    if (frozen_players) {
+        return frozen_players->sumOfLowestLevels(k);
     }
-
-    return findMthPlayerTreeNode(m, &iter);
+    return players_index->sumOfLowestLevels(k);
 }
 
-RankTreeNode<Player, PlayerRank>* Group::findMthPlayerTreeNode(int m, RankTreeIterator<Player, PlayerRank> *iter) {
-    RankTreeIterator<Player, PlayerRank>* temp_iter = iter;
-    if (iter->getPtr() == nullptr) {
-        return nullptr;
-    }
-
-    int right_node_count = 0;
-    int left_node_count = 0;
-
-    if (!temp_iter->checkNullRight()){
-        temp_iter->goRight();
-        right_node_count += temp_iter->getPtr()->getRank().getNodeCount();
-        temp_iter->goFather();
-    }
-
-    if ( right_node_count == m-1){
-        return iter->getPtr();
-    }
-
-    if (!temp_iter->checkNullLeft()){
-        temp_iter->goLeft();
-        left_node_count += temp_iter->getPtr()->getRank().getNodeCount();
-        temp_iter->goFather();
-    }
-
-    if (right_node_count >= m) {
-        iter->goRight();
-        return findMthPlayerTreeNode(m, iter);
-    }
-    else {
-        iter->goLeft();
-        return findMthPlayerTreeNode(m - right_node_count - 1, iter);
+// the level of the k-th lowest player in the tree
+int Group::getTreePlayerLevel(int k) {
+    if (frozen_players) {
+        return frozen_players->selectLevel(k);
     }
+    return players_index->selectLevel(k);
 }
 
 ReturnValue Group::calcPlayerBounds(int m, int score, int *Lower_bound_players, int *higher_bound_players) {
@@ -583,56 +684,50 @@ ReturnValue Group::calcPlayerBounds(int m, int score, int *Lower_bound_players,
         return MY_FAILURE;
     }
 
-    // m is bigger/equal to amount of players in group
-    // check amount of players in tree. if m is bigger, level_0_list is included
-    bool list_included = (non_0_level_players_tree->getSize() < m);
     int mth_player_level = 0; // level_m
     int more_than_mth_level_players = 0; // t
     int more_than_mth_with_score = 0; // k
     int players_with_mth_player_level = 0; // x
     int mth_level_with_score = 0; // y
-    ReturnValue res;
 
-    // if list is included, we need to get ALL the players from the tree, and the extra from the list
-    if (list_included) {
+    // a small group counts the players of the mth level, and above it, in its array
+    if (isSmall()) {
+        mth_player_level = small_players.getLevel(num_of_players - m);
+        small_players.countInLevelRange(mth_player_level, mth_player_level, score, &players_with_mth_player_level,
+                                        &mth_level_with_score);
+        small_players.countInLevelRange(mth_player_level + 1, INT_MAX, score, &more_than_mth_level_players,
+                                        &more_than_mth_with_score);
+    }
+    // m is bigger/equal to amount of players in group
+    // check amount of players in tree. if m is bigger, level_0_list is included:
+    // we need to get ALL the players from the tree, and the extra from the list
+    else if (players_index->getSize() < m) {
         mth_player_level = 0;
         players_with_mth_player_level = level_0_players_list->getSize();
-        mth_level_with_score = level_0_score_hist->getVal(score - 1);
-
-        more_than_mth_level_players = non_0_level_players_tree->getSize();
-        if (more_than_mth_level_players != 0) {
-            RankTreeIterator<Player, PlayerRank> iter = non_0_level_players_tree->begin();
-            RankTreeNode<Player, PlayerRank> *root_ptr = iter.getPtr();
-            more_than_mth_with_score = root_ptr->getRank().getScoreHist().getVal(score - 1);
-        }
-    }
-    else {
-        //find the level of the mth player
-        mth_player_level = findMthPlayerTreeNodeWrapper(m)->getData()->getLevel();
-
-        //find the amount of players with said level, and the amount out of them with the correct score
-        double dummy = 0;
-        res = getPercentOfPlayersWithScoreInRange(mth_player_level, mth_player_level, score, &dummy,
-                                                  &mth_level_with_score, &players_with_mth_player_level);
-        if(res != MY_SUCCESS) {
-            return res;
-        }
-
-        //find the level of the top player
-        int top_level = non_0_level_players_tree->getRightMostNode()->getData()->getLevel();
-
-        //find the amount of players with levels from mth +1 to top level, and the amount out of them with the correct score
-        if(top_level == mth_player_level){
-            more_than_mth_level_players = 0;
-            more_than_mth_with_score = 0;
+        if (score_index) {
+            mth_level_with_score = score_index->countPlayersWithScore(score, 0, 0);
         }
         else {
-            res = getPercentOfPlayersWithScoreInRange(mth_player_level + 1, top_level, score, &dummy,
-                                                      &more_than_mth_with_score, &more_than_mth_level_players);
-            if(res != MY_SUCCESS) {
-                return res;
-            }
+            mth_level_with_score = level_0_score_hist->getVal(score - 1);
         }
+        more_than_mth_level_players = players_index->getSize();
+        more_than_mth_with_score = countTreePlayersWithScore(score);
+    }
+    else {
+        //find the level of the mth player (m from the top)
+        int tree_size = players_index->getSize();
+        mth_player_level = getTreePlayerLevel(tree_size - m + 1);
+
+        //the players above the mth level are all the players, minus the players up to the mth level.
+        //the players of the mth level are the players up to the mth level, minus the players below it.
+        int upto_mth_level, upto_mth_level_with_score;
+        int below_mth_level, below_mth_level_with_score;
+        countTreePlayersUptoLevel(mth_player_level, score, &upto_mth_level, &upto_mth_level_with_score);
+        countTreePlayersUptoLevel(mth_player_level - 1, score, &below_mth_level, &below_mth_level_with_score);
+        players_with_mth_player_level = upto_mth_level - below_mth_level;
+        mth_level_with_score = upto_mth_level_with_score - below_mth_level_with_score;
+        more_than_mth_level_players = tree_size - upto_mth_level;
+        more_than_mth_with_score = countTreePlayersWithScore(score) - upto_mth_level_with_score;
     }
 
     //calculate higher bound
@@ -653,6 +748,46 @@ ReturnValue Group::calcPlayerBounds(int m, int score, int *Lower_bound_players,
     return MY_SUCCESS;
 }
 
+// returns a snapshot of the players of the group in O(1), that answers the queries as the group does now (see
+// GroupSnapshot). the caller should delete it. fails if the group doesn't keep snapshots.
+ReturnValue Group::takeSnapshot(GroupSnapshot** group_snapshot) {
+    if (!snapshot){
+        return MY_FAILURE;
+    }
+    *group_snapshot = new GroupSnapshot(*snapshot);
+    if (!*group_snapshot){
+        return MY_ALLOCATION_ERROR;
+    }
+    return MY_SUCCESS;
+}
+
+// lays the players with level > 0 out in a FrozenPlayers, for the queries until the next update of the group
+ReturnValue Group::freeze(FrozenScoreIndex score_index) {
+    // the array of a small group is flat already
+    if (isSmall() || frozen_players){
+        return MY_SUCCESS;
+    }
+    int tree_size = players_index->getSize();
+    Player** players = new Player*[tree_size];
+    if (!players){
+        return MY_ALLOCATION_ERROR;
+    }
+    int count = 0;
+    players_index->appendPlayersTo(players, &count);
+    frozen_players = new FrozenPlayers(players, count, scale, score_index);
+    delete[] players;
+    if (!frozen_players){
+        return MY_ALLOCATION_ERROR;
+    }
+    return MY_SUCCESS;
+}
+
+// drops the frozen copy of the players. every update of the group thaws it.
+void Group::thaw() {
+    delete frozen_players;
+    frozen_players = nullptr;
+}
+
 Group& Group::operator+=(Group& other_group) {
 //    if (&other_group == nullptr){
 //        throw std::exception();
@@ -662,22 +797,44 @@ Group& Group::operator+=(Group& other_group) {
         return *this;
     }
 
+    thaw();
+
+    // the players of a small group are added one by one (there are at most SMALL_GROUP_MAX_SIZE of them), and this
+    // group is promoted if it grows beyond a small group
+    if (other_group.isSmall()) {
+        for (int i = 0; i < other_group.small_players.getSize(); i++) {
+            addPlayer(other_group.small_players.getPlayer(i));
+        }
+        other_group.resetGroup();
+        return *this;
+    }
+    if (isSmall()) {
+        promote();
+    }
+
     // add other group's num_of_players to this group's num_of_players
     this->num_of_players += other_group.num_of_players;
 
     // merge other_node list into this list, and merge other_node level_0_histogram into this level_0_histogram
     this->level_0_players_list->merge_to_me(*other_group.level_0_players_list);
-    *(this->level_0_score_hist) += *(other_group.level_0_score_hist);
+    if (score_index){
+        this->score_index->mergeIndexToMe(*other_group.score_index);
+    }
+    else {
+        *(this->level_0_score_hist) += *(other_group.level_0_score_hist);
+    }
 
-    // merge other_node tree into this tree
-    this->non_0_level_players_tree->mergeTreeToMe(*other_group.non_0_level_players_tree, scale);
+    // merge other_node players_index into this players_index
+    // the handles of the players are kept by the merge, so the handles in the hash_table vals stay valid
+    this->players_index->mergeIndexToMe(*other_group.players_index);
+
+    if (snapshot){
+        this->snapshot->mergeSnapshotToMe(*other_group.snapshot);
+    }
 
     // insert all players of other_group to this group
     this->players_hash_table->mergeToMe(other_group.players_hash_table);
 
-    // after merging trees, update the tree_ptr in hash_table_val to the new tree_ptr after the merge
-    this->updateHashTableTreePtrs();
-
     // update this group's highest level players ptr
     if (this->highest_level_player == nullptr){
         if (other_group.highest_level_player != nullptr){
@@ -712,38 +869,6 @@ Group& Group::operator+=(Group& other_group) {
     return *this;
 }
 
-void Group::updateHashTableTreePtrs() {
-    RankTreeIterator<Player, PlayerRank> iter = non_0_level_players_tree->begin();
-
-    recursiveUpdateHashTableTreePtrs(iter);
-}
-
-void Group::recursiveUpdateHashTableTreePtrs(RankTreeIterator<Player, PlayerRank> iter) {
-    if (iter.getPtr() == nullptr){
-        return;
-    }
-
-    if (!iter.checkNullLeft()){
-        iter.goLeft();
-        recursiveUpdateHashTableTreePtrs(iter);
-        iter.goFather();
-    }
-
-    if (!iter.checkNullRight()){
-        iter.goRight();
-        recursiveUpdateHashTableTreePtrs(iter);
-        iter.goFather();
-    }
-
-    // find hash_table_val of curr player
-    int curr_player_id = iter.getPtr()->getData()->getPlayerID();
-    GroupHashTableVal* temp_val;
-    getPlayerArrayNode(curr_player_id, &temp_val);
-
-    // update the tree_node_ptr in the hash_table_val
-    (*temp_val).setTreeNode(iter.getPtr());
-}
-
 
 
 
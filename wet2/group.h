@@ -1,43 +1,91 @@
 #ifndef WET2_GROUP_H
 #define WET2_GROUP_H
 
-#include "rank_tree.h"
 #include "dynamic_hash_table.h"
 #include "group_hashtable_val.h"
 #include "doubly_linked_list.h"
+#include "histogram.h"
+#include "score_index.h"
+#include "group_index.h"
+#include "group_snapshot.h"
+#include "frozen_players.h"
+#include "small_group_players.h"
 
 
-typedef enum { RIGHT, LEFT, NO} CROSSED;
+// sub_trees of the players tree with up to this many players don't hold a score histogram.
+// queries count the scores of these sub_trees directly. 0 keeps a histogram in every node.
+#define DEFAULT_HIST_THRESHOLD 16
+
+// groups with a scale up to MAX_HIST_SCALE keep the scores of their players in histograms (level_0_score_hist and
+// the ranks of the players tree), which take O(scale) memory each. groups with a larger scale keep a ScoreIndex
+// instead, and the players tree holds no histograms at all.
+#define MAX_HIST_SCALE 200
+#define MAX_SCALE 65536
+
+// the GroupIndex of the groups (see GroupTreeType in group_index.h), unless the system is created with another one
+#ifndef DEFAULT_GROUP_TREE
+#define DEFAULT_GROUP_TREE AVL_TREE
+#endif
+
+// groups with snapshots keep a GroupSnapshot of their players up to date, so takeSnapshot is O(1). it costs 2 more
+// tree updates on every change of the group, so it is off by default.
+#ifndef DEFAULT_GROUP_SNAPSHOTS
+#define DEFAULT_GROUP_SNAPSHOTS false
+#endif
+
+// a group keeps up to SMALL_GROUP_MAX_SIZE players in a SmallGroupPlayers array, and allocates its hash table, list,
+// histograms and index only when it grows beyond that. it goes back to the array once it shrinks to
+// SMALL_GROUP_MIN_SIZE players, so a group around the threshold doesn't switch on every update. 0 keeps only empty
+// groups small.
+#ifndef SMALL_GROUP_MAX_SIZE
+#define SMALL_GROUP_MAX_SIZE 32
+#endif
+#define SMALL_GROUP_MIN_SIZE (SMALL_GROUP_MAX_SIZE / 4)
 
 
 class Group {
     int groupID;
     int num_of_players;
     int scale;
+    int hist_threshold;
+    GroupTreeType tree_type;
     Player* highest_level_player;
     Player* lowest_level_player;
     DynamicHashTable<GroupHashTableVal>* players_hash_table;
     DoublyLinkedList<Player>* level_0_players_list;
-    Histogram* level_0_score_hist;
-    RankTree<Player, PlayerRank>* non_0_level_players_tree;
+    Histogram* level_0_score_hist;   // nullptr when the group has a score_index
+    GroupIndex* players_index;       // the players with level > 0
+    ScoreIndex* score_index;         // nullptr when the group keeps score histograms
+    GroupSnapshot* snapshot;         // nullptr unless the group keeps snapshots
+    FrozenPlayers* frozen_players;   // nullptr unless the group is frozen
+    SmallGroupPlayers small_players; // all the players of a small group. the pointers above are nullptr then.
 
-    RankTreeNode<Player, PlayerRank>* getHighestLevelNode(int higher_bound, RankTreeNode<Player, PlayerRank>* node);
-    RankTreeNode<Player, PlayerRank>* getLowestLevelNode(int lower_bound, RankTreeNode<Player, PlayerRank>* node);
-    PlayerRank calcRankUptoNodeWrapper(RankTreeNode<Player, PlayerRank> *target_node);
-    void calcRankUptoNode(CROSSED crossed, RankTreeNode<Player, PlayerRank> *target_node,
-                                        RankTreeIterator<Player, PlayerRank> *iter, PlayerRank* rank_tot);
-    RankTreeNode<Player, PlayerRank>* findMthPlayerTreeNodeWrapper(int m);
-    RankTreeNode<Player, PlayerRank>* findMthPlayerTreeNode(int m, RankTreeIterator<Player, PlayerRank> *iter);
+    void createIndexes();
+    void deleteIndexes();
+    ReturnValue addPlayerToIndexes(Player* player);
+    // a small group keeps no hash table vals, so this fails for its players (findSmallPlayer finds them, and
+    // getPlayerPtr finds the players of any group)
+    ReturnValue getPlayerArrayNode(int player_id, GroupHashTableVal** hash_table_node);
+    ReturnValue findSmallPlayer(int player_id, int* index);
+    void promote();
+    void demote();
+
+    // the counting queries of the players with level > 0, with their scores counted by the score_index if there is one
+    // (or by the frozen_players, when the group is frozen)
+    void countTreePlayersUptoLevel(int level, int score, int* players, int* players_with_score);
+    int countTreePlayersWithScore(int score);
+    long sumTreeLowestLevels(int k);
+    int getTreePlayerLevel(int k);
 
         public:
-    Group(int new_groupID, int scale);
+    Group(int new_groupID, int scale, int hist_threshold = DEFAULT_HIST_THRESHOLD,
+          GroupTreeType tree_type = DEFAULT_GROUP_TREE, bool with_snapshots = DEFAULT_GROUP_SNAPSHOTS);
     ~Group();
 
     void resetGroup(); // this will be used in the up-tree of union.
                        // the function deletes the hashtable, tree and hist, and sets all pointers as null.
     ReturnValue addPlayer(Player* player);
     ReturnValue removePlayer(Player* player);
-    ReturnValue getPlayerArrayNode(int player_id, GroupHashTableVal** hash_table_node);
     ReturnValue getPlayerPtr(int player_id, Player** player);
     ReturnValue increasePlayerLevel(Player* player, int level_increase);
     ReturnValue updatePlayerScore(Player* player, int new_score, int old_score);
@@ -46,8 +94,12 @@ class Group {
     void updateHighestLowestPlayers();
     double calcAverageLeadPlayersLevel(int m);
     ReturnValue calcPlayerBounds(int m, int score, int* Lower_bound_players, int* higher_bound_players);
-    void updateHashTableTreePtrs();
-    void recursiveUpdateHashTableTreePtrs(RankTreeIterator<Player, PlayerRank> iter);
+    ReturnValue takeSnapshot(GroupSnapshot** group_snapshot);
+    // a frozen group answers its queries from a flat copy of its players (see FrozenPlayers), until it is updated
+    ReturnValue freeze(FrozenScoreIndex score_index = DEFAULT_FROZEN_SCORE_INDEX);
+    void thaw();
+    bool isFrozen() const { return frozen_players != nullptr; }
+    bool isSmall() const { return players_hash_table == nullptr; }
 
     Group& operator+=(Group& other_node);
 };
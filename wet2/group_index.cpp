@@ -0,0 +1,222 @@
+#include "group_index.h"
+#include <climits>
+
+GroupIndex* GroupIndex::create(GroupTreeType tree_type, int scale, int hist_threshold, bool with_hists) {
+    GroupIndex* index;
+    if (tree_type == B_PLUS_TREE) {
+        index = new BTreeGroupIndex(scale, with_hists);
+    }
+    else if (tree_type == LEVEL_INDEX) {
+        index = new LevelGroupIndex(scale, with_hists);
+    }
+    else if (tree_type == SKIP_LIST) {
+        index = new SkipListGroupIndex(scale, with_hists);
+    }
+    else {
+        // the tree holds a score histogram in no sub_tree when the group has no histograms
+        index = new RankTreeGroupIndex(scale, with_hists ? hist_threshold : INT_MAX);
+    }
+    if (!index) {
+        throw std::bad_alloc();
+    }
+    return index;
+}
+
+const MergeCounters& GroupIndex::getMergeCounters(GroupTreeType tree_type) {
+    if (tree_type == B_PLUS_TREE) {
+        return PlayerBTree::getMergeCounters();
+    }
+    if (tree_type == LEVEL_INDEX) {
+        return LevelIndex::getMergeCounters();
+    }
+    if (tree_type == SKIP_LIST) {
+        return PlayerSkipList::getMergeCounters();
+    }
+    return RankTree<Player, PlayerRank>::getMergeCounters();
+}
+
+void GroupIndex::resetMergeCounters() {
+    RankTree<Player, PlayerRank>::resetMergeCounters();
+    PlayerBTree::resetMergeCounters();
+    LevelIndex::resetMergeCounters();
+    PlayerSkipList::resetMergeCounters();
+}
+
+ReturnValue RankTreeGroupIndex::addPlayer(Player* player, GroupHashTableVal* hash_val) {
+    RankTreeNode<Player, PlayerRank>* tree_node;
+    ReturnValue res = players_tree.insert(player, scale, &tree_node);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    hash_val->setTreeNode(tree_node);
+    return MY_SUCCESS;
+}
+
+ReturnValue RankTreeGroupIndex::removePlayer(const Player&, GroupHashTableVal* hash_val) {
+    ReturnValue res = players_tree.removeNode(hash_val->getTreeNode());
+    hash_val->setTreeNode(nullptr);
+    return res;
+}
+
+ReturnValue RankTreeGroupIndex::updatePlayerLevel(Player*, const Player& old_player, GroupHashTableVal* hash_val) {
+    return players_tree.rekeyNode(hash_val->getTreeNode(), old_player);
+}
+
+// moves the player from old_score to new_score in the score_hist of every rank from its tree_node to the root
+ReturnValue RankTreeGroupIndex::updatePlayerScore(const Player&, GroupHashTableVal* hash_val, int old_score,
+                                                  int new_score) {
+    players_tree.updateScoreAlongPath(hash_val->getTreeNode(), old_score, new_score);
+    return MY_SUCCESS;
+}
+
+// the tree nodes are kept by the merge, so the tree_node ptrs in the hash_table vals stay valid
+void RankTreeGroupIndex::mergeIndexToMe(GroupIndex& other_index) {
+    players_tree.mergeTreeToMe(static_cast<RankTreeGroupIndex&>(other_index).players_tree);
+}
+
+long RankTreeGroupIndex::getSumOfLevels() {
+    if (players_tree.getSize() == 0) {
+        return 0;
+    }
+    return players_tree.begin().getPtr()->getRank().getSumOfLevels();
+}
+
+long RankTreeGroupIndex::sumOfLowestLevels(int k) {
+    // only levels are needed, so the rank holds no score histogram.
+    query_rank.clearRank(false);
+    players_tree.prefixAggregateByCount(k, &query_rank);
+    return query_rank.getSumOfLevels();
+}
+
+void RankTreeGroupIndex::countUpToLevel(int level, int score, int* players, int* players_with_score) {
+    if (!players_with_score) {
+        *players = players_tree.rankOf(Player::levelUpperBound(level));
+        return;
+    }
+    query_rank.clearRank(true);
+    players_tree.prefixAggregate(Player::levelUpperBound(level), &query_rank);
+    *players = query_rank.getNodeCount();
+    *players_with_score = query_rank.getScoreHist().getVal(score - 1);
+}
+
+int RankTreeGroupIndex::countWithScore(int score) {
+    if (players_tree.getSize() == 0) {
+        return 0;
+    }
+
+    // the root holds the histogram of the whole tree, unless the tree is too small to hold one
+    RankTreeNode<Player, PlayerRank>* root_ptr = players_tree.begin().getPtr();
+    if (root_ptr->getRank().hasScoreHist()) {
+        return root_ptr->getRank().getScoreHist().getVal(score - 1);
+    }
+    query_rank.clearRank(true);
+    root_ptr->addSubtreeRankTo(&query_rank);
+    return query_rank.getScoreHist().getVal(score - 1);
+}
+
+void RankTreeGroupIndex::appendPlayersTo(Player** players, int* count) {
+    for (RankTreeIterator<Player, PlayerRank> it = players_tree.first(); !it.isEnd(); ++it) {
+        players[(*count)++] = &*it;
+    }
+}
+
+ReturnValue BTreeGroupIndex::addPlayer(Player* player, GroupHashTableVal* hash_val) {
+    hash_val->setTreeNode(nullptr);
+    return players_btree.insert(player);
+}
+
+ReturnValue BTreeGroupIndex::removePlayer(const Player& player, GroupHashTableVal*) {
+    return players_btree.remove(player);
+}
+
+ReturnValue BTreeGroupIndex::updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal*) {
+    ReturnValue res = players_btree.remove(old_player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return players_btree.insert(player);
+}
+
+ReturnValue BTreeGroupIndex::updatePlayerScore(const Player& player, GroupHashTableVal*, int old_score,
+                                               int new_score) {
+    return players_btree.updateScore(player, old_score, new_score);
+}
+
+void BTreeGroupIndex::mergeIndexToMe(GroupIndex& other_index) {
+    players_btree.mergeTreeToMe(static_cast<BTreeGroupIndex&>(other_index).players_btree);
+}
+
+void BTreeGroupIndex::countUpToLevel(int level, int score, int* players, int* players_with_score) {
+    players_btree.countUpTo(Player::levelUpperBound(level), score, players, players_with_score);
+}
+
+// the level_index keeps the player in the list of its level, and the list node is kept in hash_val
+ReturnValue LevelGroupIndex::addPlayer(Player* player, GroupHashTableVal* hash_val) {
+    DoublyLinkedListNode<Player>* list_node;
+    ReturnValue res = level_index.addPlayer(player, &list_node);
+    hash_val->setTreeNode(nullptr);
+    hash_val->setListNode((res == MY_SUCCESS) ? list_node : nullptr);
+    return res;
+}
+
+ReturnValue LevelGroupIndex::removePlayer(const Player& player, GroupHashTableVal* hash_val) {
+    ReturnValue res = level_index.removePlayer(player, hash_val->getListNode());
+    hash_val->setNullListNode();
+    return res;
+}
+
+ReturnValue LevelGroupIndex::updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) {
+    ReturnValue res = removePlayer(old_player, hash_val);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return addPlayer(player, hash_val);
+}
+
+ReturnValue LevelGroupIndex::updatePlayerScore(const Player& player, GroupHashTableVal*, int old_score,
+                                               int new_score) {
+    return level_index.updateScore(player, old_score, new_score);
+}
+
+// the list nodes of the players are kept by the merge, so the list_node ptrs in the hash_table vals stay valid
+void LevelGroupIndex::mergeIndexToMe(GroupIndex& other_index) {
+    level_index.mergeIndexToMe(static_cast<LevelGroupIndex&>(other_index).level_index);
+}
+
+void LevelGroupIndex::countUpToLevel(int level, int score, int* players, int* players_with_score) {
+    int with_score;
+    level_index.countUpToLevel(level, score, players, &with_score);
+    if (players_with_score) {
+        *players_with_score = with_score;
+    }
+}
+
+ReturnValue SkipListGroupIndex::addPlayer(Player* player, GroupHashTableVal* hash_val) {
+    hash_val->setTreeNode(nullptr);
+    return players_list.insert(player);
+}
+
+ReturnValue SkipListGroupIndex::removePlayer(const Player& player, GroupHashTableVal*) {
+    return players_list.remove(player);
+}
+
+ReturnValue SkipListGroupIndex::updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal*) {
+    ReturnValue res = players_list.remove(old_player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return players_list.insert(player);
+}
+
+ReturnValue SkipListGroupIndex::updatePlayerScore(const Player& player, GroupHashTableVal*, int old_score,
+                                                  int new_score) {
+    return players_list.updateScore(player, old_score, new_score);
+}
+
+void SkipListGroupIndex::mergeIndexToMe(GroupIndex& other_index) {
+    players_list.mergeListToMe(static_cast<SkipListGroupIndex&>(other_index).players_list);
+}
+
+void SkipListGroupIndex::countUpToLevel(int level, int score, int* players, int* players_with_score) {
+    players_list.countUpTo(Player::levelUpperBound(level), score, players, players_with_score);
+}
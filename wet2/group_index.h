@@ -0,0 +1,168 @@
+#ifndef WET2_GROUP_INDEX_H
+#define WET2_GROUP_INDEX_H
+
+#include "rank_tree.h"
+#include "group_hashtable_val.h"
+#include "player_btree.h"
+#include "level_index.h"
+#include "player_skiplist.h"
+
+// the index that orders the players with level > 0 of a group: the RankTree (an AVL tree), a PlayerBTree, a
+// LevelIndex (a node per distinct level), or a PlayerSkipList
+typedef enum {AVL_TREE, B_PLUS_TREE, LEVEL_INDEX, SKIP_LIST} GroupTreeType;
+
+// the interface of the players index of a group. a Group keeps its level 0 players (and, with a score_index, the
+// scores of all its players) by itself, and everything else in its GroupIndex: the updates of the players with
+// level > 0, and the counting queries the percent, average and bounds queries of the group are built on.
+// the players are owned by the group. an index may keep a handle of the player (a tree node or a list node) in the
+// GroupHashTableVal of the player, and gets it back on the updates of that player. only the RankTree and LevelIndex
+// indexes keep handles (the LevelIndex uses its list node to add and remove, not to update a score). the others
+// clear the handle when a player is added, and find the player by its key on every update.
+class GroupIndex {
+public:
+    virtual ~GroupIndex() = default;
+
+    // a new empty index of the given type. with_hists is false when the group counts the scores in a score_index,
+    // and then the index only counts players and levels.
+    static GroupIndex* create(GroupTreeType tree_type, int scale, int hist_threshold, bool with_hists);
+    // how many merges of the indexes of the given type took each path (see MergeCounters in rank_tree.h)
+    static const MergeCounters& getMergeCounters(GroupTreeType tree_type);
+    static void resetMergeCounters();
+
+    virtual int getSize() const = 0;
+    virtual void clearIndex() = 0;
+    virtual ReturnValue addPlayer(Player* player, GroupHashTableVal* hash_val) = 0;
+    virtual ReturnValue removePlayer(const Player& player, GroupHashTableVal* hash_val) = 0;
+    // moves the player to its new place, after its level changed. old_player holds the player as it was added.
+    virtual ReturnValue updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) = 0;
+    virtual ReturnValue updatePlayerScore(const Player& player, GroupHashTableVal* hash_val, int old_score,
+                                          int new_score) = 0;
+    // moves all the players of other_index, which must be of the same type, to this index. the handles of the players
+    // stay valid.
+    virtual void mergeIndexToMe(GroupIndex& other_index) = 0;
+
+    // the lowest and the highest players, of an index that isn't empty
+    virtual Player* getLowestPlayer() = 0;
+    virtual Player* getHighestPlayer() = 0;
+    virtual long getSumOfLevels() = 0;
+    // the sum of the levels of the k lowest players
+    virtual long sumOfLowestLevels(int k) = 0;
+    // the level of the k-th lowest player (k starts at 1)
+    virtual int selectLevel(int k) = 0;
+    // counts the players with level <= level, and how many of them have the given score. players_with_score is
+    // nullptr when only the players are needed (and always without histograms).
+    virtual void countUpToLevel(int level, int score, int* players, int* players_with_score) = 0;
+    // the amount of players with the given score (only with histograms)
+    virtual int countWithScore(int score) = 0;
+    // appends the players to players, in order of level
+    virtual void appendPlayersTo(Player** players, int* count) = 0;
+};
+
+// the players in a RankTree. the tree node of a player is kept in its hash_val.
+class RankTreeGroupIndex : public GroupIndex {
+    RankTree<Player, PlayerRank> players_tree;
+    int scale;
+    PlayerRank query_rank;           // scratch accumulator of the read queries, reused so they don't allocate
+
+public:
+    RankTreeGroupIndex(int scale, int hist_threshold) : players_tree(hist_threshold), scale(scale),
+                                                         query_rank(scale) {}
+
+    int getSize() const override { return players_tree.getSize(); }
+    void clearIndex() override { players_tree.clearTree(); }
+    ReturnValue addPlayer(Player* player, GroupHashTableVal* hash_val) override;
+    ReturnValue removePlayer(const Player& player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerScore(const Player& player, GroupHashTableVal* hash_val, int old_score,
+                                  int new_score) override;
+    void mergeIndexToMe(GroupIndex& other_index) override;
+
+    Player* getLowestPlayer() override { return players_tree.getLeftMostNode()->getData(); }
+    Player* getHighestPlayer() override { return players_tree.getRightMostNode()->getData(); }
+    long getSumOfLevels() override;
+    long sumOfLowestLevels(int k) override;
+    int selectLevel(int k) override { return players_tree.select(k)->getData()->getLevel(); }
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) override;
+    int countWithScore(int score) override;
+    void appendPlayersTo(Player** players, int* count) override;
+};
+
+// the players in a PlayerBTree. it keeps no handles.
+class BTreeGroupIndex : public GroupIndex {
+    PlayerBTree players_btree;
+
+public:
+    BTreeGroupIndex(int scale, bool with_hists) : players_btree(scale, with_hists) {}
+
+    int getSize() const override { return players_btree.getSize(); }
+    void clearIndex() override { players_btree.clearTree(); }
+    ReturnValue addPlayer(Player* player, GroupHashTableVal* hash_val) override;
+    ReturnValue removePlayer(const Player& player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerScore(const Player& player, GroupHashTableVal* hash_val, int old_score,
+                                  int new_score) override;
+    void mergeIndexToMe(GroupIndex& other_index) override;
+
+    Player* getLowestPlayer() override { return players_btree.getLowestPlayer(); }
+    Player* getHighestPlayer() override { return players_btree.getHighestPlayer(); }
+    long getSumOfLevels() override { return players_btree.getSumOfLevels(); }
+    long sumOfLowestLevels(int k) override { return players_btree.sumOfLowestLevels(k); }
+    int selectLevel(int k) override { return players_btree.select(k)->getLevel(); }
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) override;
+    int countWithScore(int score) override { return players_btree.countWithScore(score); }
+    void appendPlayersTo(Player** players, int* count) override { players_btree.appendPlayersTo(players, count); }
+};
+
+// the players in a LevelIndex. the list node of a player (in the list of its level) is kept in its hash_val.
+class LevelGroupIndex : public GroupIndex {
+    LevelIndex level_index;
+
+public:
+    LevelGroupIndex(int scale, bool with_hists) : level_index(scale, with_hists) {}
+
+    int getSize() const override { return level_index.getSize(); }
+    void clearIndex() override { level_index.clearIndex(); }
+    ReturnValue addPlayer(Player* player, GroupHashTableVal* hash_val) override;
+    ReturnValue removePlayer(const Player& player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerScore(const Player& player, GroupHashTableVal* hash_val, int old_score,
+                                  int new_score) override;
+    void mergeIndexToMe(GroupIndex& other_index) override;
+
+    Player* getLowestPlayer() override { return level_index.getLowestPlayer(); }
+    Player* getHighestPlayer() override { return level_index.getHighestPlayer(); }
+    long getSumOfLevels() override { return level_index.getSumOfLevels(); }
+    long sumOfLowestLevels(int k) override { return level_index.sumOfLowestLevels(k); }
+    int selectLevel(int k) override { return level_index.selectLevel(k); }
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) override;
+    int countWithScore(int score) override { return level_index.countWithScore(score); }
+    void appendPlayersTo(Player** players, int* count) override { level_index.appendPlayersTo(players, count); }
+};
+
+// the players in a PlayerSkipList. it keeps no handles.
+class SkipListGroupIndex : public GroupIndex {
+    PlayerSkipList players_list;
+
+public:
+    SkipListGroupIndex(int scale, bool with_hists) : players_list(scale, with_hists) {}
+
+    int getSize() const override { return players_list.getSize(); }
+    void clearIndex() override { players_list.clearList(); }
+    ReturnValue addPlayer(Player* player, GroupHashTableVal* hash_val) override;
+    ReturnValue removePlayer(const Player& player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerLevel(Player* player, const Player& old_player, GroupHashTableVal* hash_val) override;
+    ReturnValue updatePlayerScore(const Player& player, GroupHashTableVal* hash_val, int old_score,
+                                  int new_score) override;
+    void mergeIndexToMe(GroupIndex& other_index) override;
+
+    Player* getLowestPlayer() override { return players_list.getLowestPlayer(); }
+    Player* getHighestPlayer() override { return players_list.getHighestPlayer(); }
+    long getSumOfLevels() override { return players_list.getSumOfLevels(); }
+    long sumOfLowestLevels(int k) override { return players_list.sumOfLowestLevels(k); }
+    int selectLevel(int k) override { return players_list.select(k)->getLevel(); }
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) override;
+    int countWithScore(int score) override { return players_list.countWithScore(score); }
+    void appendPlayersTo(Player** players, int* count) override { players_list.appendPlayersTo(players, count); }
+};
+
+#endif //WET2_GROUP_INDEX_H
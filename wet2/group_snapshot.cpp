@@ -0,0 +1,117 @@
+#include "group_snapshot.h"
+#include <climits>
+#include <algorithm>
+
+// the amount of players with the given score and level <= level
+int GroupSnapshot::countPlayersWithScoreUptoLevel(int score, int level) const {
+    return players_by_score.countUpTo(score, level) - players_by_score.countUpTo(score, -1);
+}
+
+ReturnValue GroupSnapshot::addPlayer(const Player& player) {
+    ReturnValue res = players_by_level.insert(player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return players_by_score.insert(player);
+}
+
+ReturnValue GroupSnapshot::removePlayer(const Player& player) {
+    ReturnValue res = players_by_level.remove(player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return players_by_score.remove(player);
+}
+
+// player already holds its new level
+ReturnValue GroupSnapshot::updatePlayerLevel(const Player& player, int old_level) {
+    Player old_player = Player(player.getPlayerID(), player.getGroupID(), player.getScore());
+    old_player.increaseLevel(old_level);
+    ReturnValue res = removePlayer(old_player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return addPlayer(player);
+}
+
+// player already holds its new score. the order by level doesn't depend on the score.
+ReturnValue GroupSnapshot::updatePlayerScore(const Player& player, int old_score) {
+    Player old_player = player;
+    old_player.setScore(old_score);
+    ReturnValue res = players_by_score.remove(old_player);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return players_by_score.insert(player);
+}
+
+void GroupSnapshot::mergeSnapshotToMe(GroupSnapshot& other_snapshot) {
+    players_by_level.mergeTreeToMe(other_snapshot.players_by_level);
+    players_by_score.mergeTreeToMe(other_snapshot.players_by_score);
+}
+
+void GroupSnapshot::clearSnapshot() {
+    players_by_level.clearTree();
+    players_by_score.clearTree();
+}
+
+ReturnValue GroupSnapshot::getPercentOfPlayersWithScoreInRange(int lowerLevel, int higherLevel, int score,
+                                                               double* percent) const {
+    if (higherLevel < lowerLevel || getNumOfPlayers() == 0) {
+        *percent = -1;
+        return MY_FAILURE;
+    }
+
+    // the players in range are the players up to higherLevel, minus the players below lowerLevel
+    int below_lower_level = (lowerLevel > 0) ? lowerLevel - 1 : -1;
+    int players_count = countPlayersUptoLevel(higherLevel) - countPlayersUptoLevel(below_lower_level);
+    int players_with_score = countPlayersWithScoreUptoLevel(score, higherLevel) -
+                             countPlayersWithScoreUptoLevel(score, below_lower_level);
+    if (players_count == 0) {
+        *percent = -1;
+        return MY_FAILURE;
+    }
+    *percent = 100*((double)players_with_score/(double)players_count);
+    return MY_SUCCESS;
+}
+
+double GroupSnapshot::calcAverageLeadPlayersLevel(int m) const {
+    int num_of_players = getNumOfPlayers();
+    if (num_of_players < m) {
+        return -1;
+    }
+
+    // the levels of the m lead players are the sum of all levels, minus the levels of the (num_of_players - m) lowest
+    long level_sum = players_by_level.getSumOfLevels() - players_by_level.sumOfLowestLevels(num_of_players - m);
+    return (double)level_sum/(double)m;
+}
+
+// the same bounds as Group::calcPlayerBounds. the level 0 players are in the trees, so the mth player is found the
+// same way whether its level is 0 or not.
+ReturnValue GroupSnapshot::calcPlayerBounds(int m, int score, int* lower_bound_players,
+                                            int* higher_bound_players) const {
+    int num_of_players = getNumOfPlayers();
+    if (num_of_players < m) {
+        return MY_FAILURE;
+    }
+    if (m == 0) {
+        *lower_bound_players = 0;
+        *higher_bound_players = 0;
+        return MY_SUCCESS;
+    }
+
+    int mth_player_level = players_by_level.selectLevel(num_of_players - m + 1);
+    int upto_mth_level = countPlayersUptoLevel(mth_player_level);
+    int upto_mth_level_with_score = countPlayersWithScoreUptoLevel(score, mth_player_level);
+    int players_with_mth_player_level = upto_mth_level - countPlayersUptoLevel(mth_player_level - 1);
+    int mth_level_with_score = upto_mth_level_with_score - countPlayersWithScoreUptoLevel(score, mth_player_level - 1);
+    int more_than_mth_level_players = num_of_players - upto_mth_level;
+    int more_than_mth_with_score = countPlayersWithScoreUptoLevel(score, INT_MAX) - upto_mth_level_with_score;
+
+    // the mth player is of the mth level: the players above it are all in, and the rest are from the mth level
+    int from_mth_level = m - more_than_mth_level_players;
+    *higher_bound_players = more_than_mth_with_score + std::min(from_mth_level, mth_level_with_score);
+    int mth_level_without_score = players_with_mth_player_level - mth_level_with_score;
+    *lower_bound_players = more_than_mth_with_score + std::max(0, from_mth_level - mth_level_without_score);
+    return MY_SUCCESS;
+}
@@ -0,0 +1,38 @@
+#ifndef WET2_GROUP_SNAPSHOT_H
+#define WET2_GROUP_SNAPSHOT_H
+
+#include "persistent_player_tree.h"
+
+// all the players of a group (level 0 included), in 2 persistent trees: by level, and by score. a group with
+// snapshots keeps one up to date, and copying it is O(1) (see PersistentPlayerTree), so a copy is a consistent
+// snapshot of the group: its queries answer as the queries of the group did when it was copied, no matter how the
+// group changes after that.
+class GroupSnapshot {
+    PersistentPlayerTree players_by_level;
+    PersistentPlayerTree players_by_score;
+
+    int countPlayersUptoLevel(int level) const { return players_by_level.countUpTo(0, level); }
+    int countPlayersWithScoreUptoLevel(int score, int level) const;
+
+public:
+    GroupSnapshot() : players_by_level(false), players_by_score(true) {}
+    GroupSnapshot(const GroupSnapshot& other_snapshot) = default;
+    ~GroupSnapshot() = default;
+    GroupSnapshot& operator=(const GroupSnapshot& other_snapshot) = delete;
+
+    // updates of the snapshot that a group keeps. the players are given as they are (or were) in the group.
+    ReturnValue addPlayer(const Player& player);
+    ReturnValue removePlayer(const Player& player);
+    ReturnValue updatePlayerLevel(const Player& player, int old_level);
+    ReturnValue updatePlayerScore(const Player& player, int old_score);
+    void mergeSnapshotToMe(GroupSnapshot& other_snapshot);
+    void clearSnapshot();
+
+    // the queries of Group
+    int getNumOfPlayers() const { return players_by_level.getSize(); }
+    ReturnValue getPercentOfPlayersWithScoreInRange(int lowerLevel, int higherLevel, int score, double* percent) const;
+    double calcAverageLeadPlayersLevel(int m) const;
+    ReturnValue calcPlayerBounds(int m, int score, int* lower_bound_players, int* higher_bound_players) const;
+};
+
+#endif //WET2_GROUP_SNAPSHOT_H
@@ -1,61 +1,434 @@
 #include "histogram.h"
+#include <climits>
+#include <cstring>
+#include <utility>
+
+// an upper bound on |a + b| and |a - b|, for counts bounded by a and b
+static int addCountBounds(int bound1, int bound2) {
+    return bound1 > INT_MAX - bound2 ? INT_MAX : bound1 + bound2;
+}
 
 
-Histogram::Histogram(int new_size){
+Histogram::Histogram(int new_size) : dense_hist(nullptr), buckets(inline_buckets), num_of_buckets(0),
+                                     buckets_capacity(HIST_INLINE_BUCKETS), max_abs_count(0), counter_width(1) {
     if (new_size <= 0){
         throw std::exception();
     }
     size = new_size;
-    hist = new int[size];
-    if (!hist){
-        throw std::bad_alloc();
+}
+
+Histogram::Histogram(const Histogram& other_hist) : dense_hist(nullptr), buckets(inline_buckets), num_of_buckets(0),
+                                                    buckets_capacity(HIST_INLINE_BUCKETS), max_abs_count(0),
+                                                    counter_width(1), size(other_hist.size) {
+    *this = other_hist;
+}
+
+Histogram::Histogram(Histogram&& other_hist) noexcept : dense_hist(nullptr), buckets(inline_buckets),
+                                                         num_of_buckets(0), buckets_capacity(HIST_INLINE_BUCKETS),
+                                                         max_abs_count(0), counter_width(1), size(other_hist.size) {
+    takeFrom(other_hist);
+}
+
+Histogram& Histogram::operator=(const Histogram& other_hist) {
+    if (this == &other_hist){
+        return *this;
     }
-    clearHistogram();
+    if (other_hist.isDense()){
+        if (!isDense() || size != other_hist.size || counter_width != other_hist.counter_width){
+            releaseMemory();
+            size = other_hist.size;
+            dense_hist = allocateCounters(other_hist.counter_width);
+        }
+        memcpy(dense_hist, other_hist.dense_hist, histPaddedSize(size) * counter_width);
+        max_abs_count = other_hist.max_abs_count;
+        return *this;
+    }
+    freeCounters();
+    size = other_hist.size;
+    max_abs_count = other_hist.max_abs_count;
+    num_of_buckets = 0;
+    reserveBuckets(other_hist.num_of_buckets);
+    memcpy(buckets, other_hist.buckets, other_hist.num_of_buckets * sizeof(Bucket));
+    num_of_buckets = other_hist.num_of_buckets;
+    return *this;
 }
 
-Histogram& Histogram::operator+=(Histogram& other_hist){
-    if (other_hist.hist == nullptr){
-        throw std::exception();
+Histogram& Histogram::operator=(Histogram&& other_hist) noexcept {
+    if (this != &other_hist){
+        releaseMemory();
+        size = other_hist.size;
+        takeFrom(other_hist);
+    }
+    return *this;
+}
+
+Histogram::~Histogram() {
+    releaseMemory();
+}
+
+// moves the counters of other_hist to this (empty, inline) histogram, and leaves other_hist empty.
+// inline buckets and counters can't be stolen, so they are copied.
+void Histogram::takeFrom(Histogram& other_hist) {
+    dense_hist = other_hist.isInlineDense() ? inline_counters : other_hist.dense_hist;
+    num_of_buckets = other_hist.num_of_buckets;
+    max_abs_count = other_hist.max_abs_count;
+    counter_width = other_hist.counter_width;
+    if (other_hist.isInlineDense()){
+        memcpy(inline_counters, other_hist.inline_counters, HIST_INLINE_BYTES);
+    }
+    else if (other_hist.isInline()){
+        memcpy(inline_buckets, other_hist.inline_buckets, other_hist.num_of_buckets * sizeof(Bucket));
+    }
+    else {
+        buckets = other_hist.buckets;
+        buckets_capacity = other_hist.buckets_capacity;
+    }
+    other_hist.dense_hist = nullptr;
+    other_hist.buckets = other_hist.inline_buckets;
+    other_hist.num_of_buckets = 0;
+    other_hist.buckets_capacity = HIST_INLINE_BUCKETS;
+    other_hist.max_abs_count = 0;
+}
+
+Histogram& Histogram::operator+=(const Histogram& other_hist){
+    max_abs_count = addCountBounds(max_abs_count, other_hist.max_abs_count);
+    if (other_hist.isDense()){
+        makeDense(histCounterWidth(max_abs_count));
+        histAddCounters(dense_hist, counter_width, other_hist.dense_hist, other_hist.counter_width, histPaddedSize(size));
+    }
+    else if (isDense()){
+        makeDense(histCounterWidth(max_abs_count));
+        addBucketsToDense(other_hist, 1);
     }
-    for (int i = 0; i < size; i++){
-        hist[i] += other_hist.hist[i];
+    else {
+        mergeSparse(other_hist, 1);
     }
     return *this;
 }
-Histogram& Histogram::operator-=(Histogram& other_hist){
-    if (other_hist.hist == nullptr){
-        throw std::exception();
+
+Histogram& Histogram::operator-=(const Histogram& other_hist){
+    max_abs_count = addCountBounds(max_abs_count, other_hist.max_abs_count);
+    if (other_hist.isDense()){
+        makeDense(histCounterWidth(max_abs_count));
+        histSubCounters(dense_hist, counter_width, other_hist.dense_hist, other_hist.counter_width, histPaddedSize(size));
+    }
+    else if (isDense()){
+        makeDense(histCounterWidth(max_abs_count));
+        addBucketsToDense(other_hist, -1);
     }
-    for (int i = 0; i < size; i++){
-        hist[i] -= other_hist.hist[i];
+    else {
+        mergeSparse(other_hist, -1);
     }
     return *this;
 }
 
-void Histogram::clearHistogram() const {
-    for (int i = 0; i < size; i++){
-        hist[i] = 0;
+// sets all counters to 0. the histogram keeps its form, and its memory for reuse.
+void Histogram::clearHistogram() {
+    if (isDense()){
+        histClearCounters(dense_hist, counter_width, histPaddedSize(size));
+    }
+    num_of_buckets = 0;
+    max_abs_count = 0;
+}
+
+// clears the histogram before counts with a total of up to max_total are added to it.
+// a dense histogram goes back to the sparse form if that many counts fit in it, and otherwise gets the counter
+// width that max_total needs (narrower counters, if the histogram had been widened before).
+void Histogram::resetHistogram(int max_total) {
+    if (isDense() && (max_total <= maxSparseBuckets(max_total) || counter_width != histCounterWidth(max_total))){
+        freeCounters();
+        if (max_total > maxSparseBuckets(max_total)){
+            dense_hist = allocateCounters(histCounterWidth(max_total));
+        }
+    }
+    clearHistogram();
+}
+
+// clears the histogram and frees all of its allocated memory, leaving only the inline buckets
+void Histogram::releaseMemory() {
+    freeCounters();
+    num_of_buckets = 0;
+    max_abs_count = 0;
+    if (!isInline()){
+        delete[] buckets;
+        buckets = inline_buckets;
+        buckets_capacity = HIST_INLINE_BUCKETS;
     }
 }
 
-void Histogram::increaseElement(int index) const {
+// this = hist1 + hist2. when both are dense, this is a single pass over the counters, with no clearing.
+// the counters get the width the sum needs, which may be narrower than the current one.
+void Histogram::setToSum(const Histogram& hist1, const Histogram& hist2) {
+    if (hist1.isDense() && hist2.isDense()){
+        int sum_bound = addCountBounds(hist1.max_abs_count, hist2.max_abs_count);
+        int width = histCounterWidth(sum_bound);
+        if (isDense() && counter_width != width){
+            freeCounters();
+        }
+        if (!isDense()){
+            num_of_buckets = 0;
+            switchToDense(width);
+        }
+        histSumCounters(dense_hist, counter_width, hist1.dense_hist, hist1.counter_width,
+                        hist2.dense_hist, hist2.counter_width, histPaddedSize(size));
+        max_abs_count = sum_bound;
+        return;
+    }
+    *this = hist1;
+    *this += hist2;
+}
+
+void Histogram::increaseElement(int index) {
     if (index < 0 || index >= size){
         throw std::exception();
     }
-    hist[index]++;
+    addToElement(index, 1);
 }
 
-void Histogram::decreaseElement(int index) const {
+void Histogram::decreaseElement(int index) {
     if (index < 0 || index >= size){
         throw std::exception();
     }
-    (hist[index])--;
+    addToElement(index, -1);
+}
+
+int Histogram::getVal(int index) const {
+    if (index < 0 || index >= size) {
+        return 0; // if index is out of bounds, returning 0 will not affect the overall result
+    }
+
+    if (isDense()){
+        return readCounter(index);
+    }
+    int position = findBucket(index);
+    if (position < num_of_buckets && buckets[position].index == index){
+        return buckets[position].count;
+    }
+    return 0;
+}
+
+// returns the position of the first bucket with bucket.index >= index (num_of_buckets if there is none)
+int Histogram::findBucket(int index) const {
+    int low = 0, high = num_of_buckets;
+    while (low < high){
+        int mid = low + (high - low) / 2;
+        if (buckets[mid].index < index){
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int Histogram::readCounter(int index) const {
+    switch (counter_width) {
+        case 1:
+            return ((const int8_t*)dense_hist)[index];
+        case 2:
+            return ((const int16_t*)dense_hist)[index];
+        default:
+            return ((const int*)dense_hist)[index];
+    }
+}
+
+// the value must fit in the counter width
+void Histogram::writeCounter(int index, int value) {
+    switch (counter_width) {
+        case 1:
+            ((int8_t*)dense_hist)[index] = (int8_t)value;
+            break;
+        case 2:
+            ((int16_t*)dense_hist)[index] = (int16_t)value;
+            break;
+        default:
+            ((int*)dense_hist)[index] = value;
+    }
+}
+
+void Histogram::addToElement(int index, int amount) {
+    if (isDense()){
+        int value = readCounter(index) + amount;
+        int abs_value = value < 0 ? -value : value;
+        if (abs_value > max_abs_count){
+            max_abs_count = abs_value;
+            makeDense(histCounterWidth(max_abs_count)); // widens the counters if the value overflows them
+        }
+        writeCounter(index, value);
+        return;
+    }
+
+    int position = findBucket(index);
+    if (position < num_of_buckets && buckets[position].index == index){
+        buckets[position].count += amount;
+        int abs_count = buckets[position].count < 0 ? -buckets[position].count : buckets[position].count;
+        if (abs_count > max_abs_count){
+            max_abs_count = abs_count;
+        }
+        if (buckets[position].count == 0){
+            // keep only non-zero counts in the sparse form
+            memmove(buckets + position, buckets + position + 1, (num_of_buckets - position - 1) * sizeof(Bucket));
+            num_of_buckets--;
+        }
+        return;
+    }
+
+    // a new bucket is needed. if the sparse form gets too big, switch to dense instead.
+    int abs_amount = amount < 0 ? -amount : amount;
+    if (abs_amount > max_abs_count){
+        max_abs_count = abs_amount;
+    }
+    if (num_of_buckets + 1 > maxSparseBuckets()){
+        switchToDense(histCounterWidth(max_abs_count));
+        writeCounter(index, amount);
+        return;
+    }
+    if (num_of_buckets == buckets_capacity){
+        reserveBuckets(buckets_capacity == 0 ? 1 : 2 * buckets_capacity);
+    }
+    memmove(buckets + position + 1, buckets + position, (num_of_buckets - position) * sizeof(Bucket));
+    buckets[position].index = index;
+    buckets[position].count = amount;
+    num_of_buckets++;
+}
+
+void Histogram::reserveBuckets(int new_capacity) {
+    if (new_capacity > maxSparseBuckets()){
+        new_capacity = maxSparseBuckets();
+    }
+    if (new_capacity <= buckets_capacity){
+        return;
+    }
+    Bucket* new_buckets = new Bucket[new_capacity];
+    if (num_of_buckets > 0){
+        memcpy(new_buckets, buckets, num_of_buckets * sizeof(Bucket));
+    }
+    if (!isInline()){
+        delete[] buckets;
+    }
+    buckets = new_buckets;
+    buckets_capacity = new_capacity;
+}
+
+// returns zeroed dense counters of the given width, inline if they fit, and sets counter_width.
+// the histogram must not hold dense counters already.
+void* Histogram::allocateCounters(int width) {
+    counter_width = width;
+    if (fitsInline(width)){
+        memset(inline_counters, 0, HIST_INLINE_BYTES);
+        return inline_counters;
+    }
+    return allocateHistCounters(histPaddedSize(size), width);
 }
 
-int Histogram::getVal(int index) {
-    if (index >= 0 && index < size) {
-        return hist[index];
+// frees the dense counters, if there are any, and leaves the histogram sparse (with no buckets)
+void Histogram::freeCounters() {
+    if (isDense() && !isInlineDense()){
+        freeHistCounters(dense_hist);
     }
+    dense_hist = nullptr;
+}
 
-    return 0; // if index is out of bounds, returning 0 will not affect the overall result
+int Histogram::getAllocatedBytes() const {
+    if (isDense()){
+        return isInlineDense() ? 0 : histPaddedSize(size) * counter_width;
+    }
+    return isInline() ? 0 : buckets_capacity * (int)sizeof(Bucket);
+}
+
+// adds the buckets of a sparse other_hist (multiplied by sign) to this dense histogram, which is wide enough
+void Histogram::addBucketsToDense(const Histogram& other_hist, int sign) {
+    for (int i = 0; i < other_hist.num_of_buckets; i++){
+        int index = other_hist.buckets[i].index;
+        writeCounter(index, readCounter(index) + sign * other_hist.buckets[i].count);
+    }
+}
+
+// makes sure the histogram is dense, with counters at least width bytes wide
+void Histogram::makeDense(int width) {
+    if (!isDense()){
+        switchToDense(width);
+        return;
+    }
+    if (counter_width >= width){
+        return;
+    }
+    // the narrow counters may be inline, where the wide ones may go too, so they are widened from a copy
+    int8_t narrow_counters[HIST_INLINE_BYTES];
+    const void* old_counters = dense_hist;
+    int old_width = counter_width;
+    if (isInlineDense()){
+        memcpy(narrow_counters, inline_counters, HIST_INLINE_BYTES);
+        old_counters = narrow_counters;
+    }
+    void* wide_counters = allocateCounters(width);
+    histAddCounters(wide_counters, width, old_counters, old_width, histPaddedSize(size));
+    if (old_counters == dense_hist){
+        freeHistCounters(dense_hist);
+    }
+    dense_hist = wide_counters;
+}
+
+void Histogram::switchToDense(int width) {
+    // the inline buckets share their memory with the inline counters, so they are moved out first
+    Bucket sparse_buckets[HIST_INLINE_BUCKETS];
+    Bucket* old_buckets = buckets;
+    if (isInline()){
+        memcpy(sparse_buckets, inline_buckets, num_of_buckets * sizeof(Bucket));
+        old_buckets = sparse_buckets;
+    }
+    dense_hist = allocateCounters(width);
+    for (int i = 0; i < num_of_buckets; i++){
+        writeCounter(old_buckets[i].index, old_buckets[i].count);
+    }
+    if (old_buckets != sparse_buckets){
+        delete[] old_buckets;
+    }
+    buckets = inline_buckets;
+    num_of_buckets = 0;
+    buckets_capacity = HIST_INLINE_BUCKETS;
+}
+
+// merges the buckets of other_hist (multiplied by sign) into this histogram. both histograms are sparse,
+// and max_abs_count is already a bound on the merged counts.
+void Histogram::mergeSparse(const Histogram& other_hist, int sign) {
+    if (other_hist.num_of_buckets == 0){
+        return;
+    }
+    if (num_of_buckets + other_hist.num_of_buckets > maxSparseBuckets()){
+        // the result may not fit in the sparse form, merge into a dense histogram
+        switchToDense(histCounterWidth(max_abs_count));
+        addBucketsToDense(other_hist, sign);
+        return;
+    }
+
+    // merge in place, from the end of the buckets array backwards, so no bucket is overwritten before it's read.
+    // buckets that cancel out are left with a 0 count, and removed afterwards.
+    int merged_size = num_of_buckets + other_hist.num_of_buckets;
+    if (merged_size > buckets_capacity){
+        reserveBuckets(merged_size > 2 * buckets_capacity ? merged_size : 2 * buckets_capacity);
+    }
+    int i = num_of_buckets - 1, j = other_hist.num_of_buckets - 1, k = merged_size - 1;
+    while (j >= 0){
+        if (i >= 0 && buckets[i].index > other_hist.buckets[j].index){
+            buckets[k--] = buckets[i--];
+        }
+        else if (i >= 0 && buckets[i].index == other_hist.buckets[j].index){
+            buckets[k].index = buckets[i].index;
+            buckets[k--].count = buckets[i--].count + sign * other_hist.buckets[j--].count;
+        }
+        else {
+            buckets[k].index = other_hist.buckets[j].index;
+            buckets[k--].count = sign * other_hist.buckets[j--].count;
+        }
+    }
+    // buckets[0..i] are already in place. move the merged buckets down to follow them, dropping 0 counts.
+    int merged_start = k + 1;
+    num_of_buckets = i + 1;
+    for (int m = merged_start; m < merged_size; m++){
+        if (buckets[m].count != 0){
+            buckets[num_of_buckets++] = buckets[m];
+        }
+    }
 }
@@ -2,19 +2,90 @@
 #define WET2_HISTOGRAM_H
 
 #include <stdexcept>
+#include "histogram_kernels.h"
 
+// bytes stored inside the Histogram object itself, before any allocation. they hold HIST_INLINE_BUCKETS sparse
+// (index, count) pairs, or the dense counters of a small scale: 1 byte counters for scales up to 64, 2 byte counters
+// for scales up to 32 (see bench/bench_node_histograms.cpp for how many node histograms this keeps from allocating)
+#ifndef HIST_INLINE_BYTES
+#define HIST_INLINE_BYTES 64
+#endif
+#define HIST_INLINE_BUCKETS (HIST_INLINE_BYTES / 8)
+
+// a histogram of `size` counters (indexes 0 to size-1).
+// while only a few counters are non-zero, the histogram is kept sparse: a sorted array of (index, count) pairs.
+// once the pairs would take more memory than `size` counters, it switches to a dense array of `size` counters.
+// dense counters are 1, 2 or 4 bytes wide, the narrowest width that holds max_abs_count (an upper bound on the
+// absolute value of every count). the counters are widened when a count would overflow them.
+// dense arrays are padded (see histogram_kernels.h). 1 and 2 byte counters are kept inline when they fit in
+// HIST_INLINE_BYTES, the rest are allocated aligned, and 4 byte counters are added/subtracted with SIMD kernels.
+// up to HIST_INLINE_BUCKETS sparse pairs are also kept inline, so a histogram of a few scores, or of a small scale,
+// allocates nothing.
 class Histogram {
+    struct Bucket {
+        int index;
+        int count;
+    };
+
+    void* dense_hist;       // nullptr while the histogram is sparse. holds histPaddedSize(size) counters, and may
+                            // point to inline_counters
+    Bucket* buckets;        // sparse form, sorted by index. only non-zero counts are kept. points to inline_buckets
+                            // while the histogram is dense
+    int num_of_buckets;
+    int buckets_capacity;
+    int max_abs_count;
+    int counter_width;      // width of the dense counters, in bytes
+    union {
+        Bucket inline_buckets[HIST_INLINE_BUCKETS];
+        int8_t inline_counters[HIST_INLINE_BYTES];
+    };
+
+    bool isDense() const { return dense_hist != nullptr; }
+    bool isInline() const { return buckets == inline_buckets; }
+    bool isInlineDense() const { return dense_hist == inline_counters; }
+    // 4 byte counters go through the aligned SIMD kernels, so they are never inline
+    bool fitsInline(int width) const {
+        return width < (int)sizeof(int) && histPaddedSize(size) * width <= HIST_INLINE_BYTES;
+    }
+    // sparse while the buckets take less memory than the dense counters would
+    int maxSparseBuckets(int max_count) const {
+        return size * histCounterWidth(max_count) / (int)sizeof(Bucket);
+    }
+    int maxSparseBuckets() const { return maxSparseBuckets(max_abs_count); }
+    int readCounter(int index) const;
+    void writeCounter(int index, int value);
+    int findBucket(int index) const;
+    void addToElement(int index, int amount);
+    void* allocateCounters(int width);
+    void freeCounters();
+    void addBucketsToDense(const Histogram& other_hist, int sign);
+    void reserveBuckets(int new_capacity);
+    void switchToDense(int width);
+    void makeDense(int width);
+    void mergeSparse(const Histogram& other_hist, int sign);
+    void takeFrom(Histogram& other_hist);
+
 public:
     int size;
-    int* hist;
-    Histogram(int size);
-    ~Histogram() = default;
-    void clearHistogram() const;
-    void increaseElement(int index) const;
-    void decreaseElement(int index) const;
-    Histogram& operator+=(Histogram& other_hist);
-    Histogram& operator-=(Histogram& other_hist);
-    int getVal(int index);
+    explicit Histogram(int size);
+    Histogram(const Histogram& other_hist);
+    Histogram(Histogram&& other_hist) noexcept;
+    Histogram& operator=(const Histogram& other_hist);
+    Histogram& operator=(Histogram&& other_hist) noexcept;
+    ~Histogram();
+    void clearHistogram();
+    void resetHistogram(int max_total);
+    void releaseMemory();
+    void setToSum(const Histogram& hist1, const Histogram& hist2);
+    void increaseElement(int index);
+    void decreaseElement(int index);
+    Histogram& operator+=(const Histogram& other_hist);
+    Histogram& operator-=(const Histogram& other_hist);
+    int getVal(int index) const;
+    bool isSparse() const { return !isDense(); }
+    int getCounterWidth() const { return counter_width; }
+    // the bytes allocated outside the Histogram object (0 while the counters or pairs are inline)
+    int getAllocatedBytes() const;
 };
 
 
@@ -0,0 +1,350 @@
+#include "histogram_kernels.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HIST_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+// scalar kernels (also used on CPUs without SIMD kernels)
+static void scalarAdd(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i++){
+        dst[i] += src[i];
+    }
+}
+
+static void scalarSub(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i++){
+        dst[i] -= src[i];
+    }
+}
+
+static void scalarSum(int* dst, const int* src1, const int* src2, int padded_size) {
+    for (int i = 0; i < padded_size; i++){
+        dst[i] = src1[i] + src2[i];
+    }
+}
+
+static void scalarClear(int* dst, int padded_size) {
+    for (int i = 0; i < padded_size; i++){
+        dst[i] = 0;
+    }
+}
+
+#ifdef HIST_X86_KERNELS
+
+// SSE2 kernels, 4 counters per vector
+__attribute__((target("sse2")))
+static void sse2Add(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 4){
+        __m128i sum = _mm_add_epi32(_mm_load_si128((const __m128i*)(dst + i)), _mm_load_si128((const __m128i*)(src + i)));
+        _mm_store_si128((__m128i*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2Sub(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 4){
+        __m128i diff = _mm_sub_epi32(_mm_load_si128((const __m128i*)(dst + i)), _mm_load_si128((const __m128i*)(src + i)));
+        _mm_store_si128((__m128i*)(dst + i), diff);
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2Sum(int* dst, const int* src1, const int* src2, int padded_size) {
+    for (int i = 0; i < padded_size; i += 4){
+        __m128i sum = _mm_add_epi32(_mm_load_si128((const __m128i*)(src1 + i)),
+                                    _mm_load_si128((const __m128i*)(src2 + i)));
+        _mm_store_si128((__m128i*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2Clear(int* dst, int padded_size) {
+    __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < padded_size; i += 4){
+        _mm_store_si128((__m128i*)(dst + i), zero);
+    }
+}
+
+// AVX2 kernels, 8 counters per vector
+__attribute__((target("avx2")))
+static void avx2Add(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 8){
+        __m256i sum = _mm256_add_epi32(_mm256_load_si256((const __m256i*)(dst + i)),
+                                       _mm256_load_si256((const __m256i*)(src + i)));
+        _mm256_store_si256((__m256i*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2Sub(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 8){
+        __m256i diff = _mm256_sub_epi32(_mm256_load_si256((const __m256i*)(dst + i)),
+                                        _mm256_load_si256((const __m256i*)(src + i)));
+        _mm256_store_si256((__m256i*)(dst + i), diff);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2Sum(int* dst, const int* src1, const int* src2, int padded_size) {
+    for (int i = 0; i < padded_size; i += 8){
+        __m256i sum = _mm256_add_epi32(_mm256_load_si256((const __m256i*)(src1 + i)),
+                                       _mm256_load_si256((const __m256i*)(src2 + i)));
+        _mm256_store_si256((__m256i*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2Clear(int* dst, int padded_size) {
+    __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < padded_size; i += 8){
+        _mm256_store_si256((__m256i*)(dst + i), zero);
+    }
+}
+
+// AVX-512 kernels, 16 counters per vector (exactly one padding unit)
+__attribute__((target("avx512f")))
+static void avx512Add(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 16){
+        __m512i sum = _mm512_add_epi32(_mm512_load_si512((const void*)(dst + i)),
+                                       _mm512_load_si512((const void*)(src + i)));
+        _mm512_store_si512((void*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Sub(int* dst, const int* src, int padded_size) {
+    for (int i = 0; i < padded_size; i += 16){
+        __m512i diff = _mm512_sub_epi32(_mm512_load_si512((const void*)(dst + i)),
+                                        _mm512_load_si512((const void*)(src + i)));
+        _mm512_store_si512((void*)(dst + i), diff);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Sum(int* dst, const int* src1, const int* src2, int padded_size) {
+    for (int i = 0; i < padded_size; i += 16){
+        __m512i sum = _mm512_add_epi32(_mm512_load_si512((const void*)(src1 + i)),
+                                       _mm512_load_si512((const void*)(src2 + i)));
+        _mm512_store_si512((void*)(dst + i), sum);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Clear(int* dst, int padded_size) {
+    __m512i zero = _mm512_setzero_si512();
+    for (int i = 0; i < padded_size; i += 16){
+        _mm512_store_si512((void*)(dst + i), zero);
+    }
+}
+
+#endif //HIST_X86_KERNELS
+
+
+static const HistKernels all_hist_kernels[NUM_OF_HIST_KERNELS] = {
+        { "scalar", scalarAdd, scalarSub, scalarSum, scalarClear },
+#ifdef HIST_X86_KERNELS
+        { "sse2", sse2Add, sse2Sub, sse2Sum, sse2Clear },
+        { "avx2", avx2Add, avx2Sub, avx2Sum, avx2Clear },
+        { "avx512", avx512Add, avx512Sub, avx512Sum, avx512Clear },
+#else
+        { "scalar", scalarAdd, scalarSub, scalarSum, scalarClear },
+        { "scalar", scalarAdd, scalarSub, scalarSum, scalarClear },
+        { "scalar", scalarAdd, scalarSub, scalarSum, scalarClear },
+#endif
+};
+
+bool histKernelsSupported(HistKernelsType type) {
+    switch (type) {
+        case HIST_KERNELS_SCALAR:
+            return true;
+#ifdef HIST_X86_KERNELS
+        case HIST_KERNELS_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case HIST_KERNELS_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case HIST_KERNELS_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+const HistKernels& getHistKernels(HistKernelsType type) {
+    return all_hist_kernels[type];
+}
+
+static HistKernels selectHistKernels() {
+#ifdef HIST_X86_KERNELS
+    __builtin_cpu_init();
+#endif
+    for (int type = NUM_OF_HIST_KERNELS - 1; type > HIST_KERNELS_SCALAR; type--){
+        if (histKernelsSupported((HistKernelsType)type)){
+            return all_hist_kernels[type];
+        }
+    }
+    return all_hist_kernels[HIST_KERNELS_SCALAR];
+}
+
+HistKernels hist_kernels = selectHistKernels();
+
+
+// narrow counters are aligned to a block of HIST_COUNTERS_PADDING counters only (16 or 32 bytes), which saves the
+// allocator's alignment overhead on small arrays
+void* allocateHistCounters(int padded_size, int counter_width) {
+    void* counters = nullptr;
+    size_t alignment = counter_width * HIST_COUNTERS_PADDING;
+    if (alignment > HIST_COUNTERS_ALIGNMENT){
+        alignment = HIST_COUNTERS_ALIGNMENT;
+    }
+#ifdef _WIN32
+    counters = _aligned_malloc(padded_size * counter_width, alignment);
+#else
+    if (posix_memalign(&counters, alignment, padded_size * counter_width) != 0){
+        counters = nullptr;
+    }
+#endif
+    if (!counters){
+        throw std::bad_alloc();
+    }
+    memset(counters, 0, padded_size * counter_width);
+    return counters;
+}
+
+void freeHistCounters(void* counters) {
+#ifdef _WIN32
+    _aligned_free(counters);
+#else
+    free(counters);
+#endif
+}
+
+
+// mixed width kernels. every block of HIST_COUNTERS_PADDING counters has a constant trip count,
+// so the compiler can vectorize the widening/narrowing of each block.
+template<int sign, typename dst_t, typename src_t>
+static void mixedAdd(dst_t* __restrict dst, const src_t* __restrict src, int padded_size) {
+    for (int i = 0; i < padded_size; i += HIST_COUNTERS_PADDING){
+        for (int j = 0; j < HIST_COUNTERS_PADDING; j++){
+            dst[i + j] = (dst_t)(dst[i + j] + sign * src[i + j]);
+        }
+    }
+}
+
+template<typename dst_t, typename src1_t, typename src2_t>
+static void mixedSum(dst_t* __restrict dst, const src1_t* __restrict src1, const src2_t* __restrict src2,
+                     int padded_size) {
+    for (int i = 0; i < padded_size; i += HIST_COUNTERS_PADDING){
+        for (int j = 0; j < HIST_COUNTERS_PADDING; j++){
+            dst[i + j] = (dst_t)(src1[i + j] + src2[i + j]);
+        }
+    }
+}
+
+// the dispatchers below pick the template instance for the runtime widths, one counters array at a time
+template<int sign, typename dst_t>
+static void mixedAddTo(dst_t* dst, const void* src, int src_width, int padded_size) {
+    switch (src_width) {
+        case 1:
+            mixedAdd<sign>(dst, (const int8_t*)src, padded_size);
+            break;
+        case 2:
+            mixedAdd<sign>(dst, (const int16_t*)src, padded_size);
+            break;
+        default:
+            mixedAdd<sign>(dst, (const int*)src, padded_size);
+    }
+}
+
+template<int sign>
+static void mixedAddCounters(void* dst, int dst_width, const void* src, int src_width, int padded_size) {
+    switch (dst_width) {
+        case 1:
+            mixedAddTo<sign>((int8_t*)dst, src, src_width, padded_size);
+            break;
+        case 2:
+            mixedAddTo<sign>((int16_t*)dst, src, src_width, padded_size);
+            break;
+        default:
+            mixedAddTo<sign>((int*)dst, src, src_width, padded_size);
+    }
+}
+
+template<typename dst_t, typename src1_t>
+static void mixedSumWith(dst_t* dst, const src1_t* src1, const void* src2, int src2_width, int padded_size) {
+    switch (src2_width) {
+        case 1:
+            mixedSum(dst, src1, (const int8_t*)src2, padded_size);
+            break;
+        case 2:
+            mixedSum(dst, src1, (const int16_t*)src2, padded_size);
+            break;
+        default:
+            mixedSum(dst, src1, (const int*)src2, padded_size);
+    }
+}
+
+template<typename dst_t>
+static void mixedSumTo(dst_t* dst, const void* src1, int src1_width, const void* src2, int src2_width,
+                       int padded_size) {
+    switch (src1_width) {
+        case 1:
+            mixedSumWith(dst, (const int8_t*)src1, src2, src2_width, padded_size);
+            break;
+        case 2:
+            mixedSumWith(dst, (const int16_t*)src1, src2, src2_width, padded_size);
+            break;
+        default:
+            mixedSumWith(dst, (const int*)src1, src2, src2_width, padded_size);
+    }
+}
+
+void histAddCounters(void* dst, int dst_width, const void* src, int src_width, int padded_size) {
+    if (dst_width == sizeof(int) && src_width == sizeof(int)){
+        hist_kernels.add((int*)dst, (const int*)src, padded_size);
+        return;
+    }
+    mixedAddCounters<1>(dst, dst_width, src, src_width, padded_size);
+}
+
+void histSubCounters(void* dst, int dst_width, const void* src, int src_width, int padded_size) {
+    if (dst_width == sizeof(int) && src_width == sizeof(int)){
+        hist_kernels.sub((int*)dst, (const int*)src, padded_size);
+        return;
+    }
+    mixedAddCounters<-1>(dst, dst_width, src, src_width, padded_size);
+}
+
+void histSumCounters(void* dst, int dst_width, const void* src1, int src1_width,
+                     const void* src2, int src2_width, int padded_size) {
+    if (dst_width == sizeof(int) && src1_width == sizeof(int) && src2_width == sizeof(int)){
+        hist_kernels.sum((int*)dst, (const int*)src1, (const int*)src2, padded_size);
+        return;
+    }
+    switch (dst_width) {
+        case 1:
+            mixedSumTo((int8_t*)dst, src1, src1_width, src2, src2_width, padded_size);
+            break;
+        case 2:
+            mixedSumTo((int16_t*)dst, src1, src1_width, src2, src2_width, padded_size);
+            break;
+        default:
+            mixedSumTo((int*)dst, src1, src1_width, src2, src2_width, padded_size);
+    }
+}
+
+void histClearCounters(void* dst, int dst_width, int padded_size) {
+    if (dst_width == sizeof(int)){
+        hist_kernels.clear((int*)dst, padded_size);
+        return;
+    }
+    memset(dst, 0, padded_size * dst_width);
+}
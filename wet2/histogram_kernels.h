@@ -0,0 +1,48 @@
+#ifndef WET2_HISTOGRAM_KERNELS_H
+#define WET2_HISTOGRAM_KERNELS_H
+
+#include <cstdint>
+
+// dense histogram int counters are allocated aligned to HIST_COUNTERS_ALIGNMENT bytes, and padded with zero counters
+// to a multiple of HIST_COUNTERS_PADDING. the kernels below may then work on whole vectors, with no tail handling.
+#define HIST_COUNTERS_ALIGNMENT 64
+#define HIST_COUNTERS_PADDING   16
+
+typedef enum { HIST_KERNELS_SCALAR, HIST_KERNELS_SSE2, HIST_KERNELS_AVX2, HIST_KERNELS_AVX512,
+               NUM_OF_HIST_KERNELS } HistKernelsType;
+
+typedef struct {
+    const char* name;
+    void (*add)(int* dst, const int* src, int padded_size);                        // dst += src
+    void (*sub)(int* dst, const int* src, int padded_size);                        // dst -= src
+    void (*sum)(int* dst, const int* src1, const int* src2, int padded_size);     // dst = src1 + src2
+    void (*clear)(int* dst, int padded_size);                                      // dst = 0
+} HistKernels;
+
+// the best kernels the running CPU supports, chosen once at startup
+extern HistKernels hist_kernels;
+
+bool histKernelsSupported(HistKernelsType type);
+const HistKernels& getHistKernels(HistKernelsType type);
+
+inline int histPaddedSize(int size) {
+    return (size + HIST_COUNTERS_PADDING - 1) / HIST_COUNTERS_PADDING * HIST_COUNTERS_PADDING;
+}
+
+// counters are 1, 2 or 4 bytes wide (int8_t, int16_t or int). returns the narrowest width that holds every count
+// in [-max_abs_count, max_abs_count].
+inline int histCounterWidth(int max_abs_count) {
+    return max_abs_count <= INT8_MAX ? 1 : (max_abs_count <= INT16_MAX ? 2 : 4);
+}
+void* allocateHistCounters(int padded_size, int counter_width); // returns zeroed counters
+void freeHistCounters(void* counters);
+
+// kernels for counters of any (possibly different) widths. the results must fit in the dst counters.
+// when all the counters are 4 bytes wide, these call the hist_kernels above.
+void histAddCounters(void* dst, int dst_width, const void* src, int src_width, int padded_size);   // dst += src
+void histSubCounters(void* dst, int dst_width, const void* src, int src_width, int padded_size);   // dst -= src
+void histSumCounters(void* dst, int dst_width, const void* src1, int src1_width,
+                     const void* src2, int src2_width, int padded_size);                           // dst = src1 + src2
+void histClearCounters(void* dst, int dst_width, int padded_size);                                 // dst = 0
+
+#endif //WET2_HISTOGRAM_KERNELS_H
@@ -0,0 +1,466 @@
+#include "level_index.h"
+#include <algorithm>
+
+MergeCounters LevelIndex::merge_counters = MergeCounters();
+
+LevelIndex::LevelIndex(int scale, bool with_hists) : root(nullptr), num_of_levels(0), scale(scale),
+                                                     with_hists(with_hists) {}
+
+LevelIndex::~LevelIndex() {
+    deleteSubtree(root);
+}
+
+void LevelIndex::clearIndex() {
+    deleteSubtree(root);
+    root = nullptr;
+    num_of_levels = 0;
+}
+
+// deletes the level nodes of the subtree, and the list nodes of their players
+void LevelIndex::deleteSubtree(LevelNode* node) {
+    if (node == nullptr) {
+        return;
+    }
+    deleteSubtree(node->left);
+    deleteSubtree(node->right);
+    DoublyLinkedListNode<Player>* list_node = node->players.getHead();
+    while (list_node != nullptr) {
+        DoublyLinkedListNode<Player>* next = list_node->getNext();
+        delete list_node;
+        list_node = next;
+    }
+    delete node;
+}
+
+LevelIndex::LevelNode* LevelIndex::rotateLeft(LevelNode* node) {
+    LevelNode* new_root = node->right;
+    node->right = new_root->left;
+    new_root->left = node;
+    return new_root;
+}
+
+LevelIndex::LevelNode* LevelIndex::rotateRight(LevelNode* node) {
+    LevelNode* new_root = node->left;
+    node->left = new_root->right;
+    new_root->right = node;
+    return new_root;
+}
+
+// recomputes the height and the subtree rank of node from its sons
+void LevelIndex::updateNode(LevelNode* node) {
+    node->height = 1 + std::max(height(node->left), height(node->right));
+    node->subtree_rank.clearRank(with_hists);
+    node->subtree_rank += node->level_rank;
+    if (node->left) {
+        node->subtree_rank += node->left->subtree_rank;
+    }
+    if (node->right) {
+        node->subtree_rank += node->right->subtree_rank;
+    }
+}
+
+// updates node, and rotates it if its sons' heights differ by 2. returns the new root of the subtree.
+LevelIndex::LevelNode* LevelIndex::balance(LevelNode* node) {
+    updateNode(node);
+    int balance_factor = height(node->left) - height(node->right);
+    if (balance_factor > 1) {
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotateLeft(node->left);
+            updateNode(node->left->left);
+        }
+        node = rotateRight(node);
+        updateNode(node->right);
+        updateNode(node);
+    }
+    else if (balance_factor < -1) {
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotateRight(node->right);
+            updateNode(node->right->right);
+        }
+        node = rotateLeft(node);
+        updateNode(node->left);
+        updateNode(node);
+    }
+    return node;
+}
+
+// adds the players of level_node to the subtree: into the node of the same level if there is one (level_node is then
+// deleted), and as a new node otherwise (inserted is set). returns the new root of the subtree.
+LevelIndex::LevelNode* LevelIndex::mergeNodeToSubtree(LevelNode* node, LevelNode* level_node, bool* inserted) {
+    if (node == nullptr) {
+        level_node->left = nullptr;
+        level_node->right = nullptr;
+        updateNode(level_node);
+        *inserted = true;
+        return level_node;
+    }
+
+    if (level_node->level == node->level) {
+        node->players.merge_to_me(level_node->players);
+        node->level_rank += level_node->level_rank;
+        node->subtree_rank += level_node->level_rank;
+        delete level_node;
+        return node;
+    }
+
+    // the ranks on the path get the players of level_node. if it is inserted as a node, they are recomputed anyway.
+    node->subtree_rank += level_node->level_rank;
+    if (level_node->level < node->level) {
+        node->left = mergeNodeToSubtree(node->left, level_node, inserted);
+    }
+    else {
+        node->right = mergeNodeToSubtree(node->right, level_node, inserted);
+    }
+    return *inserted ? balance(node) : node;
+}
+
+LevelIndex::LevelNode* LevelIndex::addToSubtree(LevelNode* node, Player* player,
+                                                DoublyLinkedListNode<Player>** list_node, bool* inserted) {
+    if (node == nullptr) {
+        node = new LevelNode(player->getLevel(), scale);
+        if (!node) throw std::bad_alloc();
+        node->level_rank.clearRank(with_hists);
+        node->level_rank.addPlayer(*player);
+        node->players.insert(player);
+        *list_node = node->players.getHead();
+        updateNode(node);
+        *inserted = true;
+        return node;
+    }
+
+    if (player->getLevel() == node->level) {
+        node->players.insert(player);
+        *list_node = node->players.getHead();
+        node->level_rank.addPlayer(*player);
+        node->subtree_rank.addPlayer(*player);
+        return node;
+    }
+
+    if (player->getLevel() < node->level) {
+        node->left = addToSubtree(node->left, player, list_node, inserted);
+    }
+    else {
+        node->right = addToSubtree(node->right, player, list_node, inserted);
+    }
+    if (*inserted) {
+        return balance(node);
+    }
+    node->subtree_rank.addPlayer(*player);
+    return node;
+}
+
+// adds the player to the node of its level (creating the node for a new level), and returns its list node, for
+// removing it later
+ReturnValue LevelIndex::addPlayer(Player* player, DoublyLinkedListNode<Player>** list_node) {
+    if (player == nullptr || list_node == nullptr) {
+        return MY_INVALID_INPUT;
+    }
+    bool inserted = false;
+    root = addToSubtree(root, player, list_node, &inserted);
+    if (inserted) {
+        num_of_levels++;
+    }
+    return MY_SUCCESS;
+}
+
+// detaches the lowest node of the subtree into min_node, and returns the new root of the subtree
+LevelIndex::LevelNode* LevelIndex::removeMin(LevelNode* node, LevelNode** min_node) {
+    if (node->left == nullptr) {
+        *min_node = node;
+        return node->right;
+    }
+    node->left = removeMin(node->left, min_node);
+    return balance(node);
+}
+
+LevelIndex::LevelNode* LevelIndex::removeFromSubtree(LevelNode* node, const Player& player,
+                                                     DoublyLinkedListNode<Player>* list_node, ReturnValue* res,
+                                                     bool* removed) {
+    if (node == nullptr) {
+        *res = ELEMENT_DOES_NOT_EXIST;
+        return nullptr;
+    }
+
+    if (player.getLevel() == node->level) {
+        node->players.remove(list_node);
+        node->level_rank.removePlayer(player);
+        node->subtree_rank.removePlayer(player);
+        *res = MY_SUCCESS;
+        if (node->players.getSize() > 0) {
+            return node;
+        }
+
+        // the level has no players left, its node is replaced by its successor
+        *removed = true;
+        LevelNode* left = node->left;
+        LevelNode* right = node->right;
+        delete node;
+        if (right == nullptr) {
+            return left;
+        }
+        LevelNode* successor;
+        right = removeMin(right, &successor);
+        successor->left = left;
+        successor->right = right;
+        return balance(successor);
+    }
+
+    if (player.getLevel() < node->level) {
+        node->left = removeFromSubtree(node->left, player, list_node, res, removed);
+    }
+    else {
+        node->right = removeFromSubtree(node->right, player, list_node, res, removed);
+    }
+    if (*res != MY_SUCCESS) {
+        return node;
+    }
+    if (*removed) {
+        return balance(node);
+    }
+    node->subtree_rank.removePlayer(player);
+    return node;
+}
+
+// removes the player, by its level and the list node addPlayer returned
+ReturnValue LevelIndex::removePlayer(const Player& player, DoublyLinkedListNode<Player>* list_node) {
+    if (list_node == nullptr) {
+        return MY_INVALID_INPUT;
+    }
+    ReturnValue res = MY_SUCCESS;
+    bool removed = false;
+    root = removeFromSubtree(root, player, list_node, &res, &removed);
+    if (removed) {
+        num_of_levels--;
+    }
+    return res;
+}
+
+// moves the player from old_score to new_score, in the ranks of its level and of the nodes above it
+ReturnValue LevelIndex::updateScore(const Player& player, int old_score, int new_score) {
+    LevelNode* node = root;
+    while (node != nullptr && node->level != player.getLevel()) {
+        node = (player.getLevel() < node->level) ? node->left : node->right;
+    }
+    if (node == nullptr) {
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+
+    node = root;
+    while (node->level != player.getLevel()) {
+        node->subtree_rank.updateScore(old_score, new_score);
+        node = (player.getLevel() < node->level) ? node->left : node->right;
+    }
+    node->subtree_rank.updateScore(old_score, new_score);
+    node->level_rank.updateScore(old_score, new_score);
+    return MY_SUCCESS;
+}
+
+// a player of the lowest level
+Player* LevelIndex::getLowestPlayer() const {
+    if (root == nullptr) {
+        return nullptr;
+    }
+    LevelNode* node = root;
+    while (node->left != nullptr) {
+        node = node->left;
+    }
+    return node->players.getTail()->getData();
+}
+
+// a player of the highest level
+Player* LevelIndex::getHighestPlayer() const {
+    if (root == nullptr) {
+        return nullptr;
+    }
+    LevelNode* node = root;
+    while (node->right != nullptr) {
+        node = node->right;
+    }
+    return node->players.getTail()->getData();
+}
+
+// the level of the k-th lowest player (k = 1 for the lowest), or -1 if there is no such player
+int LevelIndex::selectLevel(int k) const {
+    LevelNode* node = root;
+    while (node != nullptr) {
+        int left_count = node->left ? node->left->subtree_rank.getNodeCount() : 0;
+        if (k <= left_count) {
+            node = node->left;
+            continue;
+        }
+        k -= left_count;
+        if (k <= node->level_rank.getNodeCount()) {
+            return node->level;
+        }
+        k -= node->level_rank.getNodeCount();
+        node = node->right;
+    }
+    return -1;
+}
+
+// the sum of the levels of the k lowest players
+long LevelIndex::sumOfLowestLevels(int k) const {
+    long level_sum = 0;
+    LevelNode* node = root;
+    while (node != nullptr && k > 0) {
+        int left_count = node->left ? node->left->subtree_rank.getNodeCount() : 0;
+        if (k <= left_count) {
+            node = node->left;
+            continue;
+        }
+        if (node->left) {
+            level_sum += node->left->subtree_rank.getSumOfLevels();
+        }
+        k -= left_count;
+        // all the players of a level have the same level, so a part of the level sums as easily as all of it
+        int taken = std::min(k, node->level_rank.getNodeCount());
+        level_sum += (long)taken * node->level;
+        k -= taken;
+        node = node->right;
+    }
+    return level_sum;
+}
+
+// counts the players with level <= level, and how many of them have the given score. the scores are counted only by
+// indexes with score histograms.
+void LevelIndex::countUpToLevel(int level, int score, int* players, int* players_with_score) const {
+    *players = 0;
+    *players_with_score = 0;
+    LevelNode* node = root;
+    while (node != nullptr) {
+        if (node->level > level) {
+            node = node->left;
+            continue;
+        }
+        *players += node->level_rank.getNodeCount();
+        if (with_hists) {
+            *players_with_score += node->level_rank.getScoreHist().getVal(score - 1);
+        }
+        if (node->left) {
+            *players += node->left->subtree_rank.getNodeCount();
+            if (with_hists) {
+                *players_with_score += node->left->subtree_rank.getScoreHist().getVal(score - 1);
+            }
+        }
+        node = node->right;
+    }
+}
+
+// the amount of players with the given score. only for indexes with score histograms.
+int LevelIndex::countWithScore(int score) const {
+    if (root == nullptr || !with_hists) {
+        return 0;
+    }
+    return root->subtree_rank.getScoreHist().getVal(score - 1);
+}
+
+void LevelIndex::appendNodesTo(LevelNode* node, LevelNode** nodes, int* count) {
+    if (node == nullptr) {
+        return;
+    }
+    appendNodesTo(node->left, nodes, count);
+    nodes[(*count)++] = node;
+    appendNodesTo(node->right, nodes, count);
+}
+
+// builds a balanced subtree of the sorted nodes, and returns its root
+LevelIndex::LevelNode* LevelIndex::buildFromSortedNodes(LevelNode** nodes, int count) {
+    if (count == 0) {
+        return nullptr;
+    }
+    int middle = count / 2;
+    LevelNode* node = nodes[middle];
+    node->left = buildFromSortedNodes(nodes, middle);
+    node->right = buildFromSortedNodes(nodes + middle + 1, count - middle - 1);
+    updateNode(node);
+    return node;
+}
+
+// the levels of the index with less levels (small_count of them) are merged into the other one by one when that takes
+// less than rebuilding the tree from the levels of both: each merged level updates the ranks on its path, about the
+// depth of the tree, and a rebuild updates the rank of every level once.
+MergePath LevelIndex::chooseMergePath(int small_count, int large_count) {
+    int depth = 0;
+    while ((1 << depth) <= large_count) {
+        depth++;
+    }
+    return ((long)small_count * depth < large_count + small_count) ? MERGE_BY_INSERTION : MERGE_BY_REBUILD;
+}
+
+// moves all the players of other_index to this index, and leaves other_index empty. the list nodes of the players are
+// kept, so the list nodes addPlayer returned stay valid.
+void LevelIndex::mergeIndexToMe(LevelIndex& other_index) {
+    if (other_index.root == nullptr) {
+        return;
+    }
+    if (num_of_levels < other_index.num_of_levels) {
+        std::swap(root, other_index.root);
+        std::swap(num_of_levels, other_index.num_of_levels);
+    }
+
+    int other_count = 0;
+    LevelNode** other_nodes = new LevelNode*[other_index.num_of_levels];
+    if (!other_nodes) throw std::bad_alloc();
+    appendNodesTo(other_index.root, other_nodes, &other_count);
+    other_index.root = nullptr;
+    other_index.num_of_levels = 0;
+
+    MergePath path = chooseMergePath(other_count, num_of_levels);
+    merge_counters.merges[path]++;
+    if (path == MERGE_BY_INSERTION) {
+        for (int i = 0; i < other_count; i++) {
+            bool inserted = false;
+            root = mergeNodeToSubtree(root, other_nodes[i], &inserted);
+            if (inserted) {
+                num_of_levels++;
+            }
+        }
+        delete[] other_nodes;
+        return;
+    }
+
+    // both trees are listed in order, the lists are merged (joining the nodes of the same level), and the tree is
+    // rebuilt from the merged list
+    int this_count = 0;
+    LevelNode** this_nodes = new LevelNode*[num_of_levels];
+    LevelNode** merged_nodes = new LevelNode*[num_of_levels + other_count];
+    if (!this_nodes || !merged_nodes) throw std::bad_alloc();
+    appendNodesTo(root, this_nodes, &this_count);
+    int i = 0, j = 0, merged_count = 0;
+    while (i < this_count || j < other_count) {
+        if (j == other_count || (i < this_count && this_nodes[i]->level < other_nodes[j]->level)) {
+            merged_nodes[merged_count++] = this_nodes[i++];
+        }
+        else if (i == this_count || other_nodes[j]->level < this_nodes[i]->level) {
+            merged_nodes[merged_count++] = other_nodes[j++];
+        }
+        else {
+            this_nodes[i]->players.merge_to_me(other_nodes[j]->players);
+            this_nodes[i]->level_rank += other_nodes[j]->level_rank;
+            delete other_nodes[j++];
+            merged_nodes[merged_count++] = this_nodes[i++];
+        }
+    }
+    root = buildFromSortedNodes(merged_nodes, merged_count);
+    num_of_levels = merged_count;
+    delete[] this_nodes;
+    delete[] other_nodes;
+    delete[] merged_nodes;
+}
+
+// appends the players to players, in order of level (the players of a level in the order of its list)
+void LevelIndex::appendPlayersTo(Player** players, int* count) const {
+    LevelNode** nodes = new LevelNode*[num_of_levels];
+    if (!nodes) {
+        throw std::bad_alloc();
+    }
+    int num_of_nodes = 0;
+    appendNodesTo(root, nodes, &num_of_nodes);
+    for (int i = 0; i < num_of_nodes; i++) {
+        for (DoublyLinkedListNode<Player>* list_node = nodes[i]->players.getHead(); list_node != nullptr;
+             list_node = list_node->getNext()) {
+            players[(*count)++] = list_node->getData();
+        }
+    }
+    delete[] nodes;
+}
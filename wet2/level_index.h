@@ -0,0 +1,75 @@
+#ifndef WET2_LEVEL_INDEX_H
+#define WET2_LEVEL_INDEX_H
+
+#include "player.h"
+#include "player_rank.h"
+#include "doubly_linked_list.h"
+#include "rank_tree.h"
+
+// the players with level > 0 of a group, coalesced by level: an AVL tree with one node per distinct level, ordered by
+// level. a node keeps the players of its level in a list (the way a group keeps its level 0 players), the rank of
+// its level (amount of players, sum of levels, score histogram), and the rank of its whole subtree.
+// an alternative to the players RankTree of a group (see GroupTreeType in group_index.h), for groups where many
+// players share a level: the tree has a node per level, not per player, and adding or removing a player of an
+// existing level only updates the ranks on the path to its level.
+class LevelIndex {
+    struct LevelNode {
+        int level;
+        int height;
+        LevelNode* left;
+        LevelNode* right;
+        DoublyLinkedList<Player> players;
+        PlayerRank level_rank;
+        PlayerRank subtree_rank;
+
+        LevelNode(int level, int scale) : level(level), height(0), left(nullptr), right(nullptr), players(),
+                                          level_rank(scale), subtree_rank(scale) {}
+    };
+
+    LevelNode* root;
+    int num_of_levels;
+    int scale;
+    bool with_hists;
+
+    static int height(const LevelNode* node) { return node ? node->height : -1; }
+    static LevelNode* rotateLeft(LevelNode* node);
+    static LevelNode* rotateRight(LevelNode* node);
+    void updateNode(LevelNode* node);
+    LevelNode* balance(LevelNode* node);
+    LevelNode* mergeNodeToSubtree(LevelNode* node, LevelNode* level_node, bool* inserted);
+    LevelNode* addToSubtree(LevelNode* node, Player* player, DoublyLinkedListNode<Player>** list_node, bool* inserted);
+    LevelNode* removeMin(LevelNode* node, LevelNode** min_node);
+    LevelNode* removeFromSubtree(LevelNode* node, const Player& player, DoublyLinkedListNode<Player>* list_node,
+                                 ReturnValue* res, bool* removed);
+    LevelNode* buildFromSortedNodes(LevelNode** nodes, int count);
+    static void appendNodesTo(LevelNode* node, LevelNode** nodes, int* count);
+    static void deleteSubtree(LevelNode* node);
+    static MergePath chooseMergePath(int small_count, int large_count);
+    static MergeCounters merge_counters;
+
+public:
+    LevelIndex(int scale, bool with_hists);
+    ~LevelIndex();
+    LevelIndex(const LevelIndex& other_index) = delete;
+    LevelIndex& operator=(const LevelIndex& other_index) = delete;
+
+    int getSize() const { return root ? root->subtree_rank.getNodeCount() : 0; }
+    int getNumOfLevels() const { return num_of_levels; }
+    long getSumOfLevels() const { return root ? root->subtree_rank.getSumOfLevels() : 0; }
+    void clearIndex();
+    ReturnValue addPlayer(Player* player, DoublyLinkedListNode<Player>** list_node);
+    ReturnValue removePlayer(const Player& player, DoublyLinkedListNode<Player>* list_node);
+    ReturnValue updateScore(const Player& player, int old_score, int new_score);
+    Player* getLowestPlayer() const;
+    Player* getHighestPlayer() const;
+    int selectLevel(int k) const;
+    long sumOfLowestLevels(int k) const;
+    void countUpToLevel(int level, int score, int* players, int* players_with_score) const;
+    int countWithScore(int score) const;
+    void mergeIndexToMe(LevelIndex& other_index);
+    void appendPlayersTo(Player** players, int* count) const;
+    static const MergeCounters& getMergeCounters() { return merge_counters; }
+    static void resetMergeCounters() { merge_counters = MergeCounters(); }
+};
+
+#endif //WET2_LEVEL_INDEX_H
@@ -17,10 +17,14 @@ static StatusType retValToStatType(ReturnValue result){
 }
 
 void* Init(int k, int scale){
-    if(k<=0 || scale>200 || scale<=0){
+    return InitWithGroupIndex(k, scale, (GroupIndexType)DEFAULT_GROUP_TREE);
+}
+
+void* InitWithGroupIndex(int k, int scale, GroupIndexType group_index){
+    if(k<=0 || scale>MAX_SCALE || scale<=0 || group_index<GROUP_INDEX_AVL_TREE || group_index>GROUP_INDEX_SKIP_LIST){
         return nullptr;
     }
-    SystemManager* new_game_system = new SystemManager(k, scale);
+    SystemManager* new_game_system = new SystemManager(k, scale, DEFAULT_HIST_THRESHOLD, (GroupTreeType)group_index);
     if(!new_game_system){
         return nullptr;
     }
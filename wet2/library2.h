@@ -28,8 +28,22 @@ typedef enum {
 } StatusType;
 
 
+/* The index the groups keep their players in
+ * (see GroupTreeType in group_index.h)
+ * ----------------------------------- */
+typedef enum {
+    GROUP_INDEX_AVL_TREE = 0,
+    GROUP_INDEX_B_PLUS_TREE = 1,
+    GROUP_INDEX_LEVEL_INDEX = 2,
+    GROUP_INDEX_SKIP_LIST = 3
+} GroupIndexType;
+
+
 void *Init(int k, int scale);
 
+/* Init, with the groups keeping their players in the given index */
+void *InitWithGroupIndex(int k, int scale, GroupIndexType group_index);
+
 StatusType MergeGroups(void *DS, int GroupID1, int GroupID2);
 
 StatusType AddPlayer(void *DS, int PlayerID, int GroupID, int score);
@@ -85,6 +85,11 @@ if ( (read_parameters)!=(required_parameters) ) { printf(ErrorString); return er
 
 static bool isInit = false;
 
+/* The groups index of the system, when it is given as the 1st argument
+ * ("avl", "b+tree", "levels" or "skiplist"). -1 keeps the default of Init. */
+static int groupIndex = -1;
+static const char *groupIndexStr[] = { "avl", "b+tree", "levels", "skiplist" };
+
 /***************************************************************************/
 /* main                                                                    */
 /***************************************************************************/
@@ -92,6 +97,17 @@ static bool isInit = false;
 int main(int argc, const char**argv) {
     char buffer[MAX_STRING_INPUT_SIZE];
 
+    if (argc > 1) {
+        for (int index = GROUP_INDEX_AVL_TREE; index <= GROUP_INDEX_SKIP_LIST; index++) {
+            if (strcmp(argv[1], groupIndexStr[index]) == 0)
+                groupIndex = index;
+        };
+        if (groupIndex < 0) {
+            printf("Unknown group index %s.\n", argv[1]);
+            return 1;
+        };
+    };
+
     // Reading commands
     while (fgets(buffer, MAX_STRING_INPUT_SIZE, stdin) != NULL) {
         fflush(stdout);
@@ -206,7 +222,10 @@ static errorType OnInit(void** DS, const char* const command) {
     int k;
     int scale;
     ValidateRead(sscanf(command, "%d %d", &k, &scale), 2, "Init failed.\n");
-    *DS = Init(k, scale);
+    if (groupIndex < 0)
+        *DS = Init(k, scale);
+    else
+        *DS = InitWithGroupIndex(k, scale, (GroupIndexType) groupIndex);
     if (*DS == NULL) {
         printf("Init failed.\n");
         return error;
@@ -0,0 +1,355 @@
+#include "persistent_player_tree.h"
+#include <algorithm>
+#include <cmath>
+
+PersistentPlayerTree::PersistentPlayerTree(const PersistentPlayerTree& other_tree) : root(other_tree.root),
+                                                                                     by_score(other_tree.by_score) {
+    acquire(root);
+}
+
+PersistentPlayerTree::~PersistentPlayerTree() {
+    release(root);
+}
+
+void PersistentPlayerTree::clearTree() {
+    release(root);
+    root = nullptr;
+}
+
+void PersistentPlayerTree::acquire(Node* node) {
+    if (node != nullptr) {
+        node->ref_count++;
+    }
+}
+
+// drops one reference to node. once no tree or father holds node, it is deleted, and drops its references to its sons.
+void PersistentPlayerTree::release(Node* node) {
+    if (node == nullptr || --node->ref_count > 0) {
+        return;
+    }
+    release(node->left);
+    release(node->right);
+    delete node;
+}
+
+// returns a node with the entry and the sons of node, that only the caller holds (instead of its reference to node):
+// node itself if nobody else holds it, or a copy of it. the sons of a copy are shared with node.
+PersistentPlayerTree::Node* PersistentPlayerTree::own(Node* node) {
+    if (node->ref_count == 1) {
+        return node;
+    }
+    Node* copy = new Node(node->major, node->key);
+    if (!copy) {
+        throw std::bad_alloc();
+    }
+    copy->height = node->height;
+    copy->count = node->count;
+    copy->sum_of_levels = node->sum_of_levels;
+    copy->left = node->left;
+    copy->right = node->right;
+    acquire(copy->left);
+    acquire(copy->right);
+    release(node);
+    return copy;
+}
+
+// recomputes the height, the amount of entries and the sum of levels of node from its sons
+void PersistentPlayerTree::updateNode(Node* node) {
+    node->height = 1 + std::max(height(node->left), height(node->right));
+    node->count = 1 + count(node->left) + count(node->right);
+    node->sum_of_levels = (node->key >> 32) + sumOfLevels(node->left) + sumOfLevels(node->right);
+}
+
+// node must be owned by the caller. its right son is owned by the rotation.
+PersistentPlayerTree::Node* PersistentPlayerTree::rotateLeft(Node* node) {
+    Node* new_root = own(node->right);
+    node->right = new_root->left;
+    new_root->left = node;
+    updateNode(node);
+    updateNode(new_root);
+    return new_root;
+}
+
+PersistentPlayerTree::Node* PersistentPlayerTree::rotateRight(Node* node) {
+    Node* new_root = own(node->left);
+    node->left = new_root->right;
+    new_root->right = node;
+    updateNode(node);
+    updateNode(new_root);
+    return new_root;
+}
+
+// updates node (owned by the caller), and rotates it if its sons' heights differ by 2. returns the new root of the
+// subtree.
+PersistentPlayerTree::Node* PersistentPlayerTree::balance(Node* node) {
+    updateNode(node);
+    int balance_factor = height(node->left) - height(node->right);
+    if (balance_factor > 1) {
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotateLeft(own(node->left));
+        }
+        return rotateRight(node);
+    }
+    if (balance_factor < -1) {
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotateRight(own(node->right));
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+// the reference of the caller to node is passed to the returned subtree
+PersistentPlayerTree::Node* PersistentPlayerTree::insertToSubtree(Node* node, int major, long long key,
+                                                                  bool* inserted) {
+    if (node == nullptr) {
+        Node* new_node = new Node(major, key);
+        if (!new_node) {
+            throw std::bad_alloc();
+        }
+        *inserted = true;
+        return new_node;
+    }
+    if (node->major == major && node->key == key) {
+        *inserted = false;
+        return node;
+    }
+
+    node = own(node);
+    if (isBefore(major, key, node->major, node->key)) {
+        node->left = insertToSubtree(node->left, major, key, inserted);
+    }
+    else {
+        node->right = insertToSubtree(node->right, major, key, inserted);
+    }
+    return balance(node);
+}
+
+// detaches the minimal node of the subtree, owned by the caller, to *min_node. returns the rest of the subtree.
+PersistentPlayerTree::Node* PersistentPlayerTree::removeMin(Node* node, Node** min_node) {
+    node = own(node);
+    if (node->left == nullptr) {
+        Node* right_son = node->right;
+        node->right = nullptr;
+        *min_node = node;
+        return right_son;
+    }
+    node->left = removeMin(node->left, min_node);
+    return balance(node);
+}
+
+PersistentPlayerTree::Node* PersistentPlayerTree::removeFromSubtree(Node* node, int major, long long key,
+                                                                    bool* removed) {
+    if (node == nullptr) {
+        *removed = false;
+        return nullptr;
+    }
+
+    node = own(node);
+    if (node->major != major || node->key != key) {
+        if (isBefore(major, key, node->major, node->key)) {
+            node->left = removeFromSubtree(node->left, major, key, removed);
+        }
+        else {
+            node->right = removeFromSubtree(node->right, major, key, removed);
+        }
+        return balance(node);
+    }
+
+    *removed = true;
+    Node* left_son = node->left;
+    Node* right_son = node->right;
+    node->left = nullptr;
+    node->right = nullptr;
+    release(node);
+    if (left_son == nullptr) {
+        return right_son;
+    }
+    if (right_son == nullptr) {
+        return left_son;
+    }
+
+    // the successor of the removed entry takes its place
+    Node* min_node;
+    right_son = removeMin(right_son, &min_node);
+    min_node->left = left_son;
+    min_node->right = right_son;
+    return balance(min_node);
+}
+
+ReturnValue PersistentPlayerTree::insert(const Player& player) {
+    bool inserted;
+    root = insertToSubtree(root, majorOf(player), player.getTreeKey(), &inserted);
+    return inserted ? MY_SUCCESS : ELEMENT_EXISTS;
+}
+
+// the player is found by its level and id (and its score, in a by_score tree) as they were when it was inserted
+ReturnValue PersistentPlayerTree::remove(const Player& player) {
+    bool removed;
+    root = removeFromSubtree(root, majorOf(player), player.getTreeKey(), &removed);
+    return removed ? MY_SUCCESS : ELEMENT_DOES_NOT_EXIST;
+}
+
+// the amount of entries with level <= level (in a by_score tree: with a score < score, or with the given score and
+// level <= level)
+int PersistentPlayerTree::countUpTo(int score, int level) const {
+    int bound_major = by_score ? score : 0;
+    long long bound_key = Player::levelUpperBound(level).getTreeKey();
+    int players = 0;
+    const Node* node = root;
+    while (node != nullptr) {
+        if (isBefore(bound_major, bound_key, node->major, node->key)) {
+            node = node->left;
+        }
+        else {
+            players += count(node->left) + 1;
+            node = node->right;
+        }
+    }
+    return players;
+}
+
+// the level of the k-th entry (k starts at 1) of a by level tree, or -1 if there is no such entry
+int PersistentPlayerTree::selectLevel(int k) const {
+    const Node* node = root;
+    while (node != nullptr) {
+        int left_count = count(node->left);
+        if (k == left_count + 1) {
+            return (int)(node->key >> 32);
+        }
+        if (k <= left_count) {
+            node = node->left;
+        }
+        else {
+            k -= left_count + 1;
+            node = node->right;
+        }
+    }
+    return -1;
+}
+
+// the sum of the levels of the k first entries of a by level tree
+long PersistentPlayerTree::sumOfLowestLevels(int k) const {
+    long sum = 0;
+    const Node* node = root;
+    while (node != nullptr && k > 0) {
+        int left_count = count(node->left);
+        if (k <= left_count) {
+            node = node->left;
+        }
+        else {
+            sum += sumOfLevels(node->left) + (node->key >> 32);
+            k -= left_count + 1;
+            node = node->right;
+        }
+    }
+    return sum;
+}
+
+// appends the entries of the subtree, in order, to the arrays (with an explicit stack instead of recursion)
+void PersistentPlayerTree::appendEntriesTo(const Node* node, int* majors, long long* keys, int* num_of_entries) {
+    const Node* stack[RANK_TREE_MAX_HEIGHT];
+    int stack_size = 0;
+    while (node != nullptr || stack_size > 0) {
+        while (node != nullptr) {
+            stack[stack_size++] = node;
+            node = node->left;
+        }
+        node = stack[--stack_size];
+        majors[*num_of_entries] = node->major;
+        keys[*num_of_entries] = node->key;
+        (*num_of_entries)++;
+        node = node->right;
+    }
+}
+
+// builds a balanced tree of new nodes from sorted entries
+PersistentPlayerTree::Node* PersistentPlayerTree::buildFromSortedEntries(const int* majors, const long long* keys,
+                                                                         int num_of_entries) {
+    if (num_of_entries == 0) {
+        return nullptr;
+    }
+    int middle = num_of_entries / 2;
+    Node* node = new Node(majors[middle], keys[middle]);
+    if (!node) {
+        throw std::bad_alloc();
+    }
+    node->left = buildFromSortedEntries(majors, keys, middle);
+    node->right = buildFromSortedEntries(majors + middle + 1, keys + middle + 1, num_of_entries - middle - 1);
+    updateNode(node);
+    return node;
+}
+
+// moves all the entries of other_tree to this tree, and leaves other_tree empty. the trees must not share entries.
+// the entries of the smaller tree are inserted one by one when that is cheaper than building a new tree of all the
+// entries, O(min(m*log(n + m), n + m)). copies of the trees keep their entries either way.
+void PersistentPlayerTree::mergeTreeToMe(PersistentPlayerTree& other_tree) {
+    int size = getSize();
+    int other_size = other_tree.getSize();
+    if (other_size == 0) {
+        return;
+    }
+    if (other_size > size) {
+        std::swap(root, other_tree.root);
+        std::swap(size, other_size);
+    }
+
+    if (other_size * log2((double)size + other_size) < size + other_size) {
+        const Node* stack[RANK_TREE_MAX_HEIGHT];
+        int stack_size = 0;
+        const Node* node = other_tree.root;
+        while (node != nullptr || stack_size > 0) {
+            while (node != nullptr) {
+                stack[stack_size++] = node;
+                node = node->left;
+            }
+            node = stack[--stack_size];
+            bool inserted;
+            root = insertToSubtree(root, node->major, node->key, &inserted);
+            node = node->right;
+        }
+        other_tree.clearTree();
+        return;
+    }
+
+    int total = size + other_size;
+    int* majors = new int[total];
+    long long* keys = new long long[total];
+    int* other_majors = new int[other_size];
+    long long* other_keys = new long long[other_size];
+    if (!majors || !keys || !other_majors || !other_keys) {
+        throw std::bad_alloc();
+    }
+    int num_of_entries = 0;
+    appendEntriesTo(root, majors + other_size, keys + other_size, &num_of_entries);
+    int num_of_other_entries = 0;
+    appendEntriesTo(other_tree.root, other_majors, other_keys, &num_of_other_entries);
+
+    // merge from the front: the entries of this tree were put at the back of the arrays, so the merged entries never
+    // overwrite entries that weren't merged yet
+    int index = other_size;
+    int other_index = 0;
+    for (int i = 0; i < total; i++) {
+        if (other_index == other_size || (index < total && isBefore(majors[index], keys[index],
+                                                                    other_majors[other_index],
+                                                                    other_keys[other_index]))) {
+            majors[i] = majors[index];
+            keys[i] = keys[index];
+            index++;
+        }
+        else {
+            majors[i] = other_majors[other_index];
+            keys[i] = other_keys[other_index];
+            other_index++;
+        }
+    }
+
+    Node* new_root = buildFromSortedEntries(majors, keys, total);
+    release(root);
+    root = new_root;
+    other_tree.clearTree();
+    delete[] majors;
+    delete[] keys;
+    delete[] other_majors;
+    delete[] other_keys;
+}
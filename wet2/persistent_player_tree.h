@@ -0,0 +1,71 @@
+#ifndef WET2_PERSISTENT_PLAYER_TREE_H
+#define WET2_PERSISTENT_PLAYER_TREE_H
+
+#include "player.h"
+#include "rank_tree.h"
+#include <atomic>
+
+// a persistent (path copying) AVL tree of player entries, with the amount of entries and the sum of their levels in
+// every node. the entries are copies of the players (not pointers), ordered by (level, playerID), or by (score, level,
+// playerID) when the tree is by_score.
+// copying a tree is O(1): the copy shares the nodes of the tree. a node that is shared (by 2 trees, or by 2 fathers) is
+// never changed: an update copies the shared nodes on its path, so every copy keeps seeing the entries it had when it
+// was copied. the nodes are reference counted, and a node that no tree or father holds any more is deleted. nodes
+// that aren't shared are updated in place, so while no copy is alive an update allocates only the node it inserts.
+class PersistentPlayerTree {
+    struct Node {
+        int major;          // the score of the entry in a by_score tree, 0 otherwise
+        long long key;      // Player::getTreeKey of the entry
+        int height;
+        int count;
+        long sum_of_levels;
+        std::atomic<int> ref_count;
+        Node* left;
+        Node* right;
+
+        Node(int major, long long key) : major(major), key(key), height(0), count(1),
+                                         sum_of_levels(key >> 32), ref_count(1), left(nullptr), right(nullptr) {}
+    };
+
+    Node* root;
+    bool by_score;
+
+    static int height(const Node* node) { return node ? node->height : -1; }
+    static int count(const Node* node) { return node ? node->count : 0; }
+    static long sumOfLevels(const Node* node) { return node ? node->sum_of_levels : 0; }
+    static bool isBefore(int major1, long long key1, int major2, long long key2) {
+        return (major1 < major2) || (major1 == major2 && key1 < key2);
+    }
+    int majorOf(const Player& player) const { return by_score ? player.getScore() : 0; }
+
+    static void acquire(Node* node);
+    static void release(Node* node);
+    static Node* own(Node* node);
+    static void updateNode(Node* node);
+    static Node* rotateLeft(Node* node);
+    static Node* rotateRight(Node* node);
+    static Node* balance(Node* node);
+    static Node* insertToSubtree(Node* node, int major, long long key, bool* inserted);
+    static Node* removeMin(Node* node, Node** min_node);
+    static Node* removeFromSubtree(Node* node, int major, long long key, bool* removed);
+    static void appendEntriesTo(const Node* node, int* majors, long long* keys, int* num_of_entries);
+    static Node* buildFromSortedEntries(const int* majors, const long long* keys, int num_of_entries);
+
+public:
+    explicit PersistentPlayerTree(bool by_score) : root(nullptr), by_score(by_score) {}
+    PersistentPlayerTree(const PersistentPlayerTree& other_tree);
+    ~PersistentPlayerTree();
+    PersistentPlayerTree& operator=(const PersistentPlayerTree& other_tree) = delete;
+
+    int getSize() const { return count(root); }
+    long getSumOfLevels() const { return sumOfLevels(root); }
+    void clearTree();
+    ReturnValue insert(const Player& player);
+    ReturnValue remove(const Player& player);
+    int countUpTo(int score, int level) const;
+    int selectLevel(int k) const;
+    long sumOfLowestLevels(int k) const;
+    void mergeTreeToMe(PersistentPlayerTree& other_tree);
+};
+
+#endif //WET2_PERSISTENT_PLAYER_TREE_H
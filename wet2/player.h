@@ -1,6 +1,8 @@
 #ifndef WET2_PLAYER_H
 #define WET2_PLAYER_H
 
+#include <climits>
+
 class Player {
     int playerID;
     int groupID;
@@ -17,6 +19,10 @@ public:
     int getLevel() const {return level;}
     int getGroupID() const {return groupID;}
     int getKey() const {return playerID; }
+    // the key of the player in the level trees: level and playerID packed into one integer, so comparing the keys of
+    // 2 players compares them like operator< (by level, then by playerID). the level is multiplied rather than shifted,
+    // as the bounds of the queries may have a negative level
+    long long getTreeKey() const { return ((long long)level * 0x100000000LL) | (unsigned int)playerID; }
 
     bool operator==(Player other_player) const { return playerID == other_player.playerID; }
     bool operator==(const int other_player_id) const { return playerID == other_player_id; }
@@ -26,6 +32,8 @@ public:
     bool operator<(Player other_player) const;
 
     static Player playerToSearchByID(int playerID){ return Player(playerID,-1,-1); }
+    // the largest possible player with the given level: a player is <= it if and only if its level is <= level
+    static Player levelUpperBound(int level){ Player bound = Player(INT_MAX,-1,-1); bound.level = level; return bound; }
     ~Player() = default;
 };
 
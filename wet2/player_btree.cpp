@@ -0,0 +1,660 @@
+#include "player_btree.h"
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#if defined(__SSE2__) && (BTREE_NODE_SIZE % 4 == 0)
+#include <emmintrin.h>
+#define BTREE_SIMD_SEARCH
+#endif
+
+// a merge inserts the players of the smaller tree one by one while it has at most 1/BTREE_MERGE_INSERTION_RATIO of
+// the players of the bigger tree, and rebuilds both trees into one otherwise
+#define BTREE_MERGE_INSERTION_RATIO 16
+
+MergeCounters PlayerBTree::merge_counters = MergeCounters();
+
+PlayerBTree::PlayerBTree(int scale, bool with_hists) : root(nullptr), size(0), sum_of_levels(0), scale(scale),
+                                                       with_hists(with_hists) {}
+
+PlayerBTree::~PlayerBTree() {
+    deleteSubtree(root);
+}
+
+void PlayerBTree::clearTree() {
+    deleteSubtree(root);
+    root = nullptr;
+    size = 0;
+    sum_of_levels = 0;
+}
+
+// counts the entries of node with a key <= (level, id)
+int PlayerBTree::countKeysUpTo(const Node* node, int level, int id) {
+#ifdef BTREE_SIMD_SEARCH
+    // 4 keys per compare: key <= (level, id) if its level is lower, or its level is the same and its id isn't bigger
+    __m128i level_vec = _mm_set1_epi32(level);
+    __m128i id_vec = _mm_set1_epi32(id);
+    int mask = 0;
+    for (int i = 0; i < BTREE_NODE_SIZE; i += 4) {
+        __m128i levels = _mm_loadu_si128((const __m128i*)(node->levels + i));
+        __m128i ids = _mm_loadu_si128((const __m128i*)(node->ids + i));
+        __m128i lower_level = _mm_cmpgt_epi32(level_vec, levels);
+        __m128i same_level = _mm_cmpeq_epi32(level_vec, levels);
+        __m128i bigger_id = _mm_cmpgt_epi32(ids, id_vec);
+        __m128i up_to = _mm_or_si128(lower_level, _mm_andnot_si128(bigger_id, same_level));
+        mask |= _mm_movemask_ps(_mm_castsi128_ps(up_to)) << i;
+    }
+    // the INT_MAX keys of the unused entries are counted for an INT_MAX bound, so only the used entries are kept
+    mask &= (1 << node->num_of_entries) - 1;
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    while (count < node->num_of_entries && (node->levels[count] < level ||
+                                            (node->levels[count] == level && node->ids[count] <= id))) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// the child of an inner node whose keys range holds (level, id): the first child with an upper bound >= the key,
+// or the last child if the key is bigger than all of them
+int PlayerBTree::childIndex(const Node* node, int level, int id) {
+    int index = countKeysUpTo(node, level, id - 1);
+    return (index < node->num_of_entries) ? index : node->num_of_entries - 1;
+}
+
+void PlayerBTree::setKey(Node* node, int index, int level, int id) {
+    node->levels[index] = level;
+    node->ids[index] = id;
+}
+
+// sets the key of child index to the key of the child's last entry
+void PlayerBTree::setKeyToLast(Inner* node, int index) {
+    Node* child = node->children[index];
+    setKey(node, index, child->levels[child->num_of_entries - 1], child->ids[child->num_of_entries - 1]);
+}
+
+// marks the entries from index on as unused
+void PlayerBTree::clearKeysFrom(Node* node, int index) {
+    for (int i = index; i <= BTREE_NODE_SIZE; i++) {
+        setKey(node, i, INT_MAX, INT_MAX);
+    }
+}
+
+// copies count entries of src (from src_index) to dst (from dst_index). dst and src may be the same node.
+// the nodes must be of the same kind, and the amounts of entries are left for the caller to update.
+void PlayerBTree::copyEntries(Node* dst, int dst_index, const Node* src, int src_index, int count) {
+    if (count <= 0) {
+        return;
+    }
+    memmove(dst->levels + dst_index, src->levels + src_index, count * sizeof(int));
+    memmove(dst->ids + dst_index, src->ids + src_index, count * sizeof(int));
+    if (src->is_leaf) {
+        Leaf* dst_leaf = (Leaf*)dst;
+        const Leaf* src_leaf = (const Leaf*)src;
+        memmove(dst_leaf->scores + dst_index, src_leaf->scores + src_index, count * sizeof(int));
+        memmove(dst_leaf->players + dst_index, src_leaf->players + src_index, count * sizeof(Player*));
+    }
+    else {
+        Inner* dst_inner = (Inner*)dst;
+        const Inner* src_inner = (const Inner*)src;
+        memmove(dst_inner->children + dst_index, src_inner->children + src_index, count * sizeof(Node*));
+        memmove(dst_inner->child_counts + dst_index, src_inner->child_counts + src_index, count * sizeof(int));
+        memmove(dst_inner->child_level_sums + dst_index, src_inner->child_level_sums + src_index,
+                count * sizeof(long));
+        memmove(dst_inner->child_hists + dst_index, src_inner->child_hists + src_index, count * sizeof(Histogram*));
+    }
+}
+
+// opens an unused entry at index, moving the entries from index on one place up
+void PlayerBTree::insertGap(Node* node, int index) {
+    copyEntries(node, index + 1, node, index, node->num_of_entries - index);
+    node->num_of_entries++;
+}
+
+// removes the entry at index, moving the entries after it one place down
+void PlayerBTree::eraseEntry(Node* node, int index) {
+    copyEntries(node, index, node, index + 1, node->num_of_entries - index - 1);
+    node->num_of_entries--;
+    clearKeysFrom(node, node->num_of_entries);
+}
+
+int PlayerBTree::countScoreInLeaf(const Leaf* leaf, int num_of_entries, int score) {
+    int count = 0;
+    for (int i = 0; i < num_of_entries; i++) {
+        count += (leaf->scores[i] == score);
+    }
+    return count;
+}
+
+PlayerBTree::Leaf* PlayerBTree::newLeaf() {
+    Leaf* leaf = new Leaf();
+    if (!leaf) throw std::bad_alloc();
+    leaf->num_of_entries = 0;
+    leaf->is_leaf = true;
+    clearKeysFrom(leaf, 0);
+    return leaf;
+}
+
+PlayerBTree::Inner* PlayerBTree::newInner() {
+    Inner* inner = new Inner();
+    if (!inner) throw std::bad_alloc();
+    inner->num_of_entries = 0;
+    inner->is_leaf = false;
+    clearKeysFrom(inner, 0);
+    return inner;
+}
+
+void PlayerBTree::deleteSubtree(Node* node) {
+    if (node == nullptr) {
+        return;
+    }
+    if (node->is_leaf) {
+        delete (Leaf*)node;
+        return;
+    }
+    Inner* inner = (Inner*)node;
+    for (int i = 0; i < inner->num_of_entries; i++) {
+        deleteSubtree(inner->children[i]);
+        delete inner->child_hists[i];
+    }
+    delete inner;
+}
+
+// recomputes the aggregates of child index from the child's own entries
+void PlayerBTree::computeChildAggregate(Inner* node, int index) {
+    Node* child = node->children[index];
+    int count = 0;
+    long level_sum = 0;
+    if (child->is_leaf) {
+        count = child->num_of_entries;
+        for (int i = 0; i < child->num_of_entries; i++) {
+            level_sum += child->levels[i];
+        }
+        node->child_counts[index] = count;
+        node->child_level_sums[index] = level_sum;
+        return;
+    }
+
+    Inner* inner_child = (Inner*)child;
+    for (int i = 0; i < inner_child->num_of_entries; i++) {
+        count += inner_child->child_counts[i];
+        level_sum += inner_child->child_level_sums[i];
+    }
+    node->child_counts[index] = count;
+    node->child_level_sums[index] = level_sum;
+    if (!with_hists) {
+        return;
+    }
+    if (!node->child_hists[index]) {
+        node->child_hists[index] = new Histogram(scale);
+        if (!node->child_hists[index]) throw std::bad_alloc();
+    }
+    Histogram* hist = node->child_hists[index];
+    hist->clearHistogram();
+    for (int i = 0; i < inner_child->num_of_entries; i++) {
+        if (inner_child->child_hists[i]) {
+            *hist += *inner_child->child_hists[i];
+            continue;
+        }
+        Leaf* leaf = (Leaf*)inner_child->children[i];
+        for (int j = 0; j < leaf->num_of_entries; j++) {
+            hist->increaseElement(leaf->scores[j] - 1);
+        }
+    }
+}
+
+// the amount of players with the given score under child index. only for trees with score histograms.
+int PlayerBTree::countChildScore(const Inner* node, int index, int score) const {
+    if (node->child_hists[index]) {
+        return node->child_hists[index]->getVal(score - 1);
+    }
+    const Leaf* leaf = (const Leaf*)node->children[index];
+    return countScoreInLeaf(leaf, leaf->num_of_entries, score);
+}
+
+// splits an overflowing node in 2, and returns the new node, which holds the upper half of the entries
+PlayerBTree::Node* PlayerBTree::splitNode(Node* node) {
+    Node* sibling = node->is_leaf ? (Node*)newLeaf() : (Node*)newInner();
+    int keep = (node->num_of_entries + 1) / 2;
+    copyEntries(sibling, 0, node, keep, node->num_of_entries - keep);
+    sibling->num_of_entries = node->num_of_entries - keep;
+    node->num_of_entries = keep;
+    clearKeysFrom(node, keep);
+    return sibling;
+}
+
+ReturnValue PlayerBTree::insertToSubtree(Node* node, Player* player, Node** new_sibling) {
+    int level = player->getLevel(), id = player->getPlayerID();
+    if (node->is_leaf) {
+        Leaf* leaf = (Leaf*)node;
+        int index = countKeysUpTo(leaf, level, id - 1);
+        if (index < leaf->num_of_entries && leaf->levels[index] == level && leaf->ids[index] == id) {
+            return ELEMENT_EXISTS;
+        }
+        insertGap(leaf, index);
+        setKey(leaf, index, level, id);
+        leaf->scores[index] = player->getScore();
+        leaf->players[index] = player;
+    }
+    else {
+        Inner* inner = (Inner*)node;
+        int index = childIndex(inner, level, id);
+        Node* child_sibling = nullptr;
+        ReturnValue res = insertToSubtree(inner->children[index], player, &child_sibling);
+        if (res != MY_SUCCESS) {
+            return res;
+        }
+
+        // only the last child can get a key above its upper bound
+        if (inner->levels[index] < level || (inner->levels[index] == level && inner->ids[index] < id)) {
+            setKey(inner, index, level, id);
+        }
+        if (child_sibling == nullptr) {
+            inner->child_counts[index]++;
+            inner->child_level_sums[index] += level;
+            if (inner->child_hists[index]) {
+                inner->child_hists[index]->increaseElement(player->getScore() - 1);
+            }
+        }
+        else {
+            // the child was split: its upper half goes right after it, under the child's old upper bound
+            insertGap(inner, index + 1);
+            inner->children[index + 1] = child_sibling;
+            inner->child_hists[index + 1] = nullptr;
+            setKey(inner, index + 1, inner->levels[index], inner->ids[index]);
+            setKeyToLast(inner, index);
+            computeChildAggregate(inner, index);
+            computeChildAggregate(inner, index + 1);
+        }
+    }
+
+    if (node->num_of_entries > BTREE_NODE_SIZE) {
+        *new_sibling = splitNode(node);
+    }
+    return MY_SUCCESS;
+}
+
+ReturnValue PlayerBTree::insert(Player* player) {
+    if (player == nullptr) {
+        return MY_INVALID_INPUT;
+    }
+    if (root == nullptr) {
+        root = newLeaf();
+    }
+    Node* new_sibling = nullptr;
+    ReturnValue res = insertToSubtree(root, player, &new_sibling);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+
+    // the root was split, the tree grows by a level
+    if (new_sibling) {
+        Inner* new_root = newInner();
+        new_root->num_of_entries = 2;
+        new_root->children[0] = root;
+        new_root->children[1] = new_sibling;
+        new_root->child_hists[0] = nullptr;
+        new_root->child_hists[1] = nullptr;
+        setKeyToLast(new_root, 0);
+        setKeyToLast(new_root, 1);
+        computeChildAggregate(new_root, 0);
+        computeChildAggregate(new_root, 1);
+        root = new_root;
+    }
+    size++;
+    sum_of_levels += player->getLevel();
+    return MY_SUCCESS;
+}
+
+// refills child index, which has less than BTREE_MIN_NODE_SIZE entries, from one of its siblings: merges the 2 if
+// they fit in one node, and moves entries between them otherwise
+void PlayerBTree::fixUnderflow(Inner* node, int index) {
+    int left_index = (index > 0) ? index - 1 : index;
+    int right_index = left_index + 1;
+    Node* left = node->children[left_index];
+    Node* right = node->children[right_index];
+
+    if (left->num_of_entries + right->num_of_entries <= BTREE_NODE_SIZE) {
+        copyEntries(left, left->num_of_entries, right, 0, right->num_of_entries);
+        left->num_of_entries += right->num_of_entries;
+        setKey(node, left_index, node->levels[right_index], node->ids[right_index]);
+        delete node->child_hists[right_index];
+        if (right->is_leaf) {
+            delete (Leaf*)right;
+        }
+        else {
+            delete (Inner*)right;
+        }
+        eraseEntry(node, right_index);
+        computeChildAggregate(node, left_index);
+        return;
+    }
+
+    if (left->num_of_entries < right->num_of_entries) {
+        int moved = (right->num_of_entries - left->num_of_entries) / 2;
+        copyEntries(left, left->num_of_entries, right, 0, moved);
+        left->num_of_entries += moved;
+        copyEntries(right, 0, right, moved, right->num_of_entries - moved);
+        right->num_of_entries -= moved;
+        clearKeysFrom(right, right->num_of_entries);
+    }
+    else {
+        int moved = (left->num_of_entries - right->num_of_entries) / 2;
+        copyEntries(right, moved, right, 0, right->num_of_entries);
+        copyEntries(right, 0, left, left->num_of_entries - moved, moved);
+        right->num_of_entries += moved;
+        left->num_of_entries -= moved;
+        clearKeysFrom(left, left->num_of_entries);
+    }
+    setKeyToLast(node, left_index);
+    computeChildAggregate(node, left_index);
+    computeChildAggregate(node, right_index);
+}
+
+ReturnValue PlayerBTree::removeFromSubtree(Node* node, int level, int id, int* removed_score) {
+    if (node->is_leaf) {
+        Leaf* leaf = (Leaf*)node;
+        int index = countKeysUpTo(leaf, level, id - 1);
+        if (index >= leaf->num_of_entries || leaf->levels[index] != level || leaf->ids[index] != id) {
+            return ELEMENT_DOES_NOT_EXIST;
+        }
+        *removed_score = leaf->scores[index];
+        eraseEntry(leaf, index);
+        return MY_SUCCESS;
+    }
+
+    Inner* inner = (Inner*)node;
+    int index = childIndex(inner, level, id);
+    ReturnValue res = removeFromSubtree(inner->children[index], level, id, removed_score);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    inner->child_counts[index]--;
+    inner->child_level_sums[index] -= level;
+    if (inner->child_hists[index]) {
+        inner->child_hists[index]->decreaseElement(*removed_score - 1);
+    }
+    if (inner->children[index]->num_of_entries < BTREE_MIN_NODE_SIZE) {
+        fixUnderflow(inner, index);
+    }
+    return MY_SUCCESS;
+}
+
+ReturnValue PlayerBTree::remove(const Player& player) {
+    if (root == nullptr) {
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+    int removed_score;
+    ReturnValue res = removeFromSubtree(root, player.getLevel(), player.getPlayerID(), &removed_score);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+
+    // a root with a single child is replaced by the child, and an empty root leaf is deleted
+    if (!root->is_leaf && root->num_of_entries == 1) {
+        Inner* old_root = (Inner*)root;
+        root = old_root->children[0];
+        delete old_root->child_hists[0];
+        delete old_root;
+    }
+    else if (root->is_leaf && root->num_of_entries == 0) {
+        delete (Leaf*)root;
+        root = nullptr;
+    }
+    size--;
+    sum_of_levels -= player.getLevel();
+    return MY_SUCCESS;
+}
+
+ReturnValue PlayerBTree::updateScoreInSubtree(Node* node, int level, int id, int old_score, int new_score) {
+    if (node->is_leaf) {
+        Leaf* leaf = (Leaf*)node;
+        int index = countKeysUpTo(leaf, level, id - 1);
+        if (index >= leaf->num_of_entries || leaf->levels[index] != level || leaf->ids[index] != id) {
+            return ELEMENT_DOES_NOT_EXIST;
+        }
+        leaf->scores[index] = new_score;
+        return MY_SUCCESS;
+    }
+
+    Inner* inner = (Inner*)node;
+    int index = childIndex(inner, level, id);
+    ReturnValue res = updateScoreInSubtree(inner->children[index], level, id, old_score, new_score);
+    if (res == MY_SUCCESS && inner->child_hists[index]) {
+        inner->child_hists[index]->decreaseElement(old_score - 1);
+        inner->child_hists[index]->increaseElement(new_score - 1);
+    }
+    return res;
+}
+
+// moves the player from old_score to new_score. the player is searched by its (level, id) key.
+ReturnValue PlayerBTree::updateScore(const Player& player, int old_score, int new_score) {
+    if (root == nullptr) {
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+    return updateScoreInSubtree(root, player.getLevel(), player.getPlayerID(), old_score, new_score);
+}
+
+Player* PlayerBTree::getLowestPlayer() const {
+    if (root == nullptr) {
+        return nullptr;
+    }
+    Node* node = root;
+    while (!node->is_leaf) {
+        node = ((Inner*)node)->children[0];
+    }
+    return ((Leaf*)node)->players[0];
+}
+
+Player* PlayerBTree::getHighestPlayer() const {
+    if (root == nullptr) {
+        return nullptr;
+    }
+    Node* node = root;
+    while (!node->is_leaf) {
+        node = ((Inner*)node)->children[node->num_of_entries - 1];
+    }
+    return ((Leaf*)node)->players[node->num_of_entries - 1];
+}
+
+// the k-th lowest player (k = 1 for the lowest), or nullptr if there is no such player
+Player* PlayerBTree::select(int k) const {
+    if (k <= 0 || k > size) {
+        return nullptr;
+    }
+    Node* node = root;
+    while (!node->is_leaf) {
+        Inner* inner = (Inner*)node;
+        int index = 0;
+        while (k > inner->child_counts[index]) {
+            k -= inner->child_counts[index];
+            index++;
+        }
+        node = inner->children[index];
+    }
+    return ((Leaf*)node)->players[k - 1];
+}
+
+// the sum of the levels of the k lowest players
+long PlayerBTree::sumOfLowestLevels(int k) const {
+    long level_sum = 0;
+    Node* node = root;
+    while (k > 0 && node != nullptr) {
+        if (node->is_leaf) {
+            for (int i = 0; i < k && i < node->num_of_entries; i++) {
+                level_sum += node->levels[i];
+            }
+            break;
+        }
+        Inner* inner = (Inner*)node;
+        int index = 0;
+        while (index < inner->num_of_entries && k >= inner->child_counts[index]) {
+            k -= inner->child_counts[index];
+            level_sum += inner->child_level_sums[index];
+            index++;
+        }
+        node = (index < inner->num_of_entries) ? inner->children[index] : nullptr;
+    }
+    return level_sum;
+}
+
+// counts the players <= upper_bound, and how many of them have the given score. the scores are counted only by
+// trees with score histograms, and only if players_with_score isn't nullptr.
+void PlayerBTree::countUpTo(const Player& upper_bound, int score, int* players, int* players_with_score) const {
+    int level = upper_bound.getLevel(), id = upper_bound.getPlayerID();
+    bool count_scores = with_hists && players_with_score != nullptr;
+    *players = 0;
+    if (players_with_score) {
+        *players_with_score = 0;
+    }
+
+    // the children with an upper bound <= the key are counted whole, and the search goes on in the next child
+    Node* node = root;
+    while (node != nullptr) {
+        int index = countKeysUpTo(node, level, id);
+        if (node->is_leaf) {
+            *players += index;
+            if (count_scores) {
+                *players_with_score += countScoreInLeaf((Leaf*)node, index, score);
+            }
+            break;
+        }
+        Inner* inner = (Inner*)node;
+        for (int i = 0; i < index; i++) {
+            *players += inner->child_counts[i];
+            if (count_scores) {
+                *players_with_score += countChildScore(inner, i, score);
+            }
+        }
+        node = (index < inner->num_of_entries) ? inner->children[index] : nullptr;
+    }
+}
+
+// the amount of players with the given score. only for trees with score histograms.
+int PlayerBTree::countWithScore(int score) const {
+    if (root == nullptr || !with_hists) {
+        return 0;
+    }
+    if (root->is_leaf) {
+        return countScoreInLeaf((Leaf*)root, root->num_of_entries, score);
+    }
+    Inner* inner = (Inner*)root;
+    int count = 0;
+    for (int i = 0; i < inner->num_of_entries; i++) {
+        count += countChildScore(inner, i, score);
+    }
+    return count;
+}
+
+// appends the players of the subtree to players, in order
+void PlayerBTree::appendPlayersTo(Node* node, Player** players, int* count) const {
+    if (node == nullptr) {
+        return;
+    }
+    if (node->is_leaf) {
+        memcpy(players + *count, ((Leaf*)node)->players, node->num_of_entries * sizeof(Player*));
+        *count += node->num_of_entries;
+        return;
+    }
+    Inner* inner = (Inner*)node;
+    for (int i = 0; i < inner->num_of_entries; i++) {
+        appendPlayersTo(inner->children[i], players, count);
+    }
+}
+
+// builds the tree bottom up from sorted players, with full nodes. the entries are spread evenly over the nodes of
+// each level, so every node but the root holds at least BTREE_MIN_NODE_SIZE of them.
+void PlayerBTree::buildFromSortedPlayers(Player** players, int count) {
+    clearTree();
+    if (count == 0) {
+        return;
+    }
+
+    int num_of_nodes = (count + BTREE_NODE_SIZE - 1) / BTREE_NODE_SIZE;
+    Node** nodes = new Node*[num_of_nodes];
+    if (!nodes) throw std::bad_alloc();
+    int next = 0;
+    for (int i = 0; i < num_of_nodes; i++) {
+        Leaf* leaf = newLeaf();
+        leaf->num_of_entries = count / num_of_nodes + (i < count % num_of_nodes);
+        for (int j = 0; j < leaf->num_of_entries; j++) {
+            Player* player = players[next++];
+            setKey(leaf, j, player->getLevel(), player->getPlayerID());
+            leaf->scores[j] = player->getScore();
+            leaf->players[j] = player;
+            sum_of_levels += player->getLevel();
+        }
+        nodes[i] = leaf;
+    }
+
+    // each level of inner nodes takes the nodes of the level below as children, in place
+    while (num_of_nodes > 1) {
+        int num_of_parents = (num_of_nodes + BTREE_NODE_SIZE - 1) / BTREE_NODE_SIZE;
+        next = 0;
+        for (int i = 0; i < num_of_parents; i++) {
+            Inner* parent = newInner();
+            parent->num_of_entries = num_of_nodes / num_of_parents + (i < num_of_nodes % num_of_parents);
+            for (int j = 0; j < parent->num_of_entries; j++) {
+                parent->children[j] = nodes[next++];
+                parent->child_hists[j] = nullptr;
+                setKeyToLast(parent, j);
+                computeChildAggregate(parent, j);
+            }
+            nodes[i] = parent;
+        }
+        num_of_nodes = num_of_parents;
+    }
+    root = nodes[0];
+    size = count;
+    delete[] nodes;
+}
+
+// a B+tree merge is by insertion or by rebuild, never by union
+MergePath PlayerBTree::chooseMergePath(int small_size, int large_size) {
+    return ((long)small_size * BTREE_MERGE_INSERTION_RATIO <= large_size) ? MERGE_BY_INSERTION : MERGE_BY_REBUILD;
+}
+
+// moves all the players of other_tree to this tree, and leaves other_tree empty
+void PlayerBTree::mergeTreeToMe(PlayerBTree& other_tree) {
+    if (other_tree.size == 0) {
+        return;
+    }
+    // the players of the smaller tree are moved into the bigger one
+    if (size < other_tree.size) {
+        std::swap(root, other_tree.root);
+        std::swap(size, other_tree.size);
+        std::swap(sum_of_levels, other_tree.sum_of_levels);
+    }
+
+    int count = 0;
+    MergePath path = chooseMergePath(other_tree.size, size);
+    merge_counters.merges[path]++;
+    if (path == MERGE_BY_INSERTION) {
+        Player** other_players = new Player*[other_tree.size];
+        if (!other_players) throw std::bad_alloc();
+        other_tree.appendPlayersTo(other_tree.root, other_players, &count);
+        for (int i = 0; i < count; i++) {
+            insert(other_players[i]);
+        }
+        delete[] other_players;
+        other_tree.clearTree();
+        return;
+    }
+
+    // both trees are listed in order, the lists are merged, and the tree is rebuilt from the merged list
+    Player** this_players = new Player*[size];
+    Player** other_players = new Player*[other_tree.size];
+    Player** merged_players = new Player*[size + other_tree.size];
+    if (!this_players || !other_players || !merged_players) throw std::bad_alloc();
+    appendPlayersTo(root, this_players, &count);
+    count = 0;
+    other_tree.appendPlayersTo(other_tree.root, other_players, &count);
+    std::merge(this_players, this_players + size, other_players, other_players + other_tree.size, merged_players,
+               [](const Player* player1, const Player* player2) { return *player1 < *player2; });
+    buildFromSortedPlayers(merged_players, size + other_tree.size);
+    other_tree.clearTree();
+    delete[] this_players;
+    delete[] other_players;
+    delete[] merged_players;
+}
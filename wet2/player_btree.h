@@ -0,0 +1,96 @@
+#ifndef WET2_PLAYER_BTREE_H
+#define WET2_PLAYER_BTREE_H
+
+#include "player.h"
+#include "histogram.h"
+#include "rank_tree.h"
+
+// max entries of a node: players of a leaf, children of an inner node. nodes other than the root keep at least
+// BTREE_MIN_NODE_SIZE entries.
+#define BTREE_NODE_SIZE 16
+#define BTREE_MIN_NODE_SIZE (BTREE_NODE_SIZE / 2)
+
+// the players with level > 0 of a group, in a B+tree ordered by (level, id). an alternative to the players RankTree
+// of a group (see GroupTreeType in group_index.h), with the same counting queries.
+// the keys of a node are stored contiguously and searched with SIMD compares, and an inner node keeps the aggregates
+// of its children (amount of players, sum of levels, score histogram) next to the child pointers, so a query reads
+// one node per level instead of one node per player on the path.
+class PlayerBTree {
+    struct Node {
+        int num_of_entries;
+        bool is_leaf;
+        // the key of entry i is (levels[i], ids[i]): the player's key in a leaf, and an upper bound of the keys of
+        // child i in an inner node (smaller than every key of child i+1). unused entries hold INT_MAX keys.
+        // one extra entry holds the overflow of an insertion until the node is split.
+        int levels[BTREE_NODE_SIZE + 1];
+        int ids[BTREE_NODE_SIZE + 1];
+    };
+    struct Leaf : Node {
+        int scores[BTREE_NODE_SIZE + 1];
+        Player* players[BTREE_NODE_SIZE + 1];
+    };
+    // child_hists[i] is nullptr when child i is a leaf (its scores are counted directly), or when the tree keeps no
+    // score histograms.
+    struct Inner : Node {
+        Node* children[BTREE_NODE_SIZE + 1];
+        int child_counts[BTREE_NODE_SIZE + 1];
+        long child_level_sums[BTREE_NODE_SIZE + 1];
+        Histogram* child_hists[BTREE_NODE_SIZE + 1];
+    };
+
+    Node* root;
+    int size;
+    long sum_of_levels;
+    int scale;
+    bool with_hists;
+
+    static int countKeysUpTo(const Node* node, int level, int id);
+    static int childIndex(const Node* node, int level, int id);
+    static void setKey(Node* node, int index, int level, int id);
+    static void setKeyToLast(Inner* node, int index);
+    static void clearKeysFrom(Node* node, int index);
+    static void copyEntries(Node* dst, int dst_index, const Node* src, int src_index, int count);
+    static void insertGap(Node* node, int index);
+    static void eraseEntry(Node* node, int index);
+    static int countScoreInLeaf(const Leaf* leaf, int num_of_entries, int score);
+
+    Leaf* newLeaf();
+    Inner* newInner();
+    void deleteSubtree(Node* node);
+    void computeChildAggregate(Inner* node, int index);
+    int countChildScore(const Inner* node, int index, int score) const;
+    Node* splitNode(Node* node);
+    ReturnValue insertToSubtree(Node* node, Player* player, Node** new_sibling);
+    ReturnValue removeFromSubtree(Node* node, int level, int id, int* removed_score);
+    void fixUnderflow(Inner* node, int index);
+    ReturnValue updateScoreInSubtree(Node* node, int level, int id, int old_score, int new_score);
+    void appendPlayersTo(Node* node, Player** players, int* count) const;
+    void buildFromSortedPlayers(Player** players, int count);
+    static MergePath chooseMergePath(int small_size, int large_size);
+    static MergeCounters merge_counters;
+
+public:
+    PlayerBTree(int scale, bool with_hists);
+    ~PlayerBTree();
+    PlayerBTree(const PlayerBTree& other_tree) = delete;
+    PlayerBTree& operator=(const PlayerBTree& other_tree) = delete;
+
+    int getSize() const { return size; }
+    long getSumOfLevels() const { return sum_of_levels; }
+    void clearTree();
+    ReturnValue insert(Player* player);
+    ReturnValue remove(const Player& player);
+    ReturnValue updateScore(const Player& player, int old_score, int new_score);
+    Player* getLowestPlayer() const;
+    Player* getHighestPlayer() const;
+    Player* select(int k) const;
+    long sumOfLowestLevels(int k) const;
+    void countUpTo(const Player& upper_bound, int score, int* players, int* players_with_score) const;
+    int countWithScore(int score) const;
+    void mergeTreeToMe(PlayerBTree& other_tree);
+    void appendPlayersTo(Player** players, int* count) const { appendPlayersTo(root, players, count); }
+    static const MergeCounters& getMergeCounters() { return merge_counters; }
+    static void resetMergeCounters() { merge_counters = MergeCounters(); }
+};
+
+#endif //WET2_PLAYER_BTREE_H
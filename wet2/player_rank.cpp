@@ -1,28 +1,108 @@
 #include "player_rank.h"
+#include <utility>
 
-PlayerRank::PlayerRank(int scale){
-    node_count = 0;
-    sum_of_levels = 0;
-    score_hist = new Histogram(scale);
+PlayerRank::PlayerRank(int scale) : node_count(0), with_score_hist(true), sum_of_levels(0), score_hist(scale) {}
+
+void PlayerRank::swap(PlayerRank& other_player_rank) noexcept {
+    std::swap(node_count, other_player_rank.node_count);
+    std::swap(with_score_hist, other_player_rank.with_score_hist);
+    std::swap(sum_of_levels, other_player_rank.sum_of_levels);
+    std::swap(score_hist, other_player_rank.score_hist);
 }
 
 void PlayerRank::initializeRank(Player player) {
     node_count = 1;
     sum_of_levels = player.getLevel();
-    score_hist->clearHistogram();
-    score_hist->increaseElement(player.getScore()-1);
+    if (with_score_hist){
+        score_hist.clearHistogram();
+        score_hist.increaseElement(player.getScore()-1);
+    }
+}
+
+// empties the rank, for reuse as an accumulator. the histogram keeps its memory (even if with_hist is false), so a
+// rank that is cleared and refilled over and over stops allocating once its histogram is big enough.
+void PlayerRank::clearRank(bool with_hist) {
+    node_count = 0;
+    sum_of_levels = 0;
+    with_score_hist = with_hist;
+    score_hist.clearHistogram();
+}
+
+// the rank of a node with 2 sons: the node's player, plus the ranks of both sons.
+// if with_hist, both sons must hold a score histogram, and the sum of both is built in one pass.
+void PlayerRank::initializeRank(Player player, const PlayerRank& left_rank, const PlayerRank& right_rank,
+                                bool with_hist) {
+    node_count = 1 + left_rank.node_count + right_rank.node_count;
+    sum_of_levels = player.getLevel() + left_rank.sum_of_levels + right_rank.sum_of_levels;
+    if (!with_hist){
+        dropScoreHist();
+        return;
+    }
+    with_score_hist = true;
+    score_hist.setToSum(left_rank.score_hist, right_rank.score_hist);
+    score_hist.increaseElement(player.getScore()-1);
+}
+
+// moves one player from the old_score bucket to the new_score bucket, without touching the rest of the histogram
+void PlayerRank::updateScore(int old_score, int new_score) {
+    if (with_score_hist){
+        score_hist.decreaseElement(old_score-1);
+        score_hist.increaseElement(new_score-1);
+    }
 }
 
+// adds a single player to the rank (the rank of a subtree that the player was inserted into)
+void PlayerRank::addPlayer(Player player) {
+    node_count++;
+    sum_of_levels += player.getLevel();
+    addPlayerScore(player);
+}
+
+// removes a single player from the rank (the rank of a subtree that the player was removed from)
+void PlayerRank::removePlayer(Player player) {
+    node_count--;
+    sum_of_levels -= player.getLevel();
+    removePlayerScore(player);
+}
 
-PlayerRank& PlayerRank::operator+=(PlayerRank& other_player_rank){
+// node_count and sum_of_levels are always added. the score histograms are added only if both ranks hold one,
+// if only this rank holds a histogram, the scores of the other rank's players should be added one by one.
+PlayerRank& PlayerRank::operator+=(const PlayerRank& other_player_rank){
     node_count += other_player_rank.node_count;
     sum_of_levels += other_player_rank.sum_of_levels;
-    *score_hist += *other_player_rank.score_hist;
+    if (with_score_hist && other_player_rank.with_score_hist){
+        score_hist += other_player_rank.score_hist;
+    }
     return *this;
 }
-PlayerRank& PlayerRank::operator-=(PlayerRank& other_player_rank){
+PlayerRank& PlayerRank::operator-=(const PlayerRank& other_player_rank){
     node_count -= other_player_rank.node_count;
     sum_of_levels -= other_player_rank.sum_of_levels;
-    *score_hist -= *other_player_rank.score_hist;
+    if (with_score_hist && other_player_rank.with_score_hist){
+        score_hist -= other_player_rank.score_hist;
+    }
     return *this;
 }
+
+// starts holding an empty score histogram (or clears the held one), for the scores of up to max_players players
+void PlayerRank::createScoreHist(int max_players) {
+    with_score_hist = true;
+    score_hist.resetHistogram(max_players);
+}
+
+void PlayerRank::dropScoreHist() {
+    with_score_hist = false;
+    score_hist.releaseMemory();
+}
+
+void PlayerRank::addPlayerScore(Player player) {
+    if (with_score_hist){
+        score_hist.increaseElement(player.getScore()-1);
+    }
+}
+
+void PlayerRank::removePlayerScore(Player player) {
+    if (with_score_hist){
+        score_hist.decreaseElement(player.getScore()-1);
+    }
+}
@@ -4,21 +4,39 @@
 #include "player.h"
 #include "histogram.h"
 
+// the rank of a sub_tree of players: the amount of players, the sum of their levels, and a histogram of their scores.
+// the score histogram may be dropped (for small sub_trees, see RankTree's hist_threshold), and then only
+// node_count and sum_of_levels are kept.
+// the histogram is held by value, so a rank (and the tree node holding it) needs no allocation of its own.
 class PlayerRank {
     int node_count;
+    bool with_score_hist;
     long sum_of_levels;
-    Histogram* score_hist;
+    Histogram score_hist;
 
 public:
     explicit PlayerRank(int scale);
     ~PlayerRank() = default;
+    void swap(PlayerRank& other_player_rank) noexcept;
 
     void initializeRank(Player player);
-    int getNodeCount() { return node_count; }
-    long getSumOfLevels() { return sum_of_levels; }
-    Histogram getScoreHist() { return *score_hist; }
-    PlayerRank& operator+=(PlayerRank& other_player_rank);
-    PlayerRank& operator-=(PlayerRank& other_player_rank);
+    void clearRank(bool with_hist);
+    void initializeRank(Player player, const PlayerRank& left_rank, const PlayerRank& right_rank, bool with_hist);
+    void updateScore(int old_score, int new_score);
+    void addPlayer(Player player);
+    void removePlayer(Player player);
+    int getNodeCount() const { return node_count; }
+    long getSumOfLevels() const { return sum_of_levels; }
+    const Histogram& getScoreHist() const { return score_hist; }
+    PlayerRank& operator+=(const PlayerRank& other_player_rank);
+    PlayerRank& operator-=(const PlayerRank& other_player_rank);
+
+    // score histogram elision
+    bool hasScoreHist() const { return with_score_hist; }
+    void createScoreHist(int max_players);
+    void dropScoreHist();
+    void addPlayerScore(Player player);
+    void removePlayerScore(Player player);
 };
 
 #endif //WET2_PLAYER_RANK_H
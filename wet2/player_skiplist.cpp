@@ -0,0 +1,694 @@
+#include "player_skiplist.h"
+#include <climits>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+MergeCounters PlayerSkipList::merge_counters = MergeCounters();
+std::atomic<unsigned long> PlayerSkipList::epoch(1);
+std::atomic<unsigned long> PlayerSkipList::reader_epochs[SKIPLIST_MAX_READERS];
+
+PlayerSkipList::PlayerSkipList(int scale, bool with_hists) : header(nullptr), height(1), size(0), sum_of_levels(0),
+                                                             scale(scale), with_hists(with_hists), score_hist(nullptr),
+                                                             version(0), random_state(2463534242u), retired(nullptr),
+                                                             num_of_retired(0), retired_capacity(0) {
+    Node* first = new Node();
+    if (!first) throw std::bad_alloc();
+    first->links = new Link[SKIPLIST_MAX_HEIGHT];
+    if (!first->links) throw std::bad_alloc();
+    first->key = LLONG_MIN;
+    first->level = 0;
+    first->score = 0;
+    first->height = SKIPLIST_MAX_HEIGHT;
+    first->player = nullptr;
+    header = first;
+    if (with_hists) {
+        score_hist = new Histogram(scale);
+        if (!score_hist) throw std::bad_alloc();
+    }
+}
+
+// readers of other lists may still be on the nodes of this list (a merge swaps the nodes of the lists), so the nodes
+// are retired like removed ones, and the list waits until they are freed
+PlayerSkipList::~PlayerSkipList() {
+    clearNodes();
+    retire(header, false, score_hist);
+    while (num_of_retired > 0) {
+        reclaim();
+        if (num_of_retired > 0) {
+            std::this_thread::yield();
+        }
+    }
+    delete[] retired;
+}
+
+// takes a free reader slot, with the epoch the read starts in. the fence orders the slot before the reads of the
+// list, so a writer that doesn't see the slot has unlinked everything it frees before the reader reads
+PlayerSkipList::ReadSection::ReadSection() {
+    static thread_local int next_slot = 0;
+    for (int tries = 1; ; tries++) {
+        unsigned long free_slot = 0;
+        if (reader_epochs[next_slot].compare_exchange_strong(free_slot, epoch.load())) {
+            slot = next_slot;
+            break;
+        }
+        next_slot = (next_slot + 1) % SKIPLIST_MAX_READERS;
+        if (tries % SKIPLIST_MAX_READERS == 0) {
+            std::this_thread::yield();
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+PlayerSkipList::ReadSection::~ReadSection() {
+    reader_epochs[slot].store(0, std::memory_order_release);
+}
+
+// the version the read starts from, once no writer is in the list
+unsigned int PlayerSkipList::beginRead() const {
+    unsigned int start_version = version;
+    while (start_version % 2 == 1) {
+        std::this_thread::yield();
+        start_version = version;
+    }
+    return start_version;
+}
+
+// true if the reads since beginRead saw the list as of start_version
+bool PlayerSkipList::endRead(unsigned int start_version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == start_version;
+}
+
+void PlayerSkipList::beginWrite() {
+    while (true) {
+        unsigned int current_version = version.load(std::memory_order_relaxed);
+        if (current_version % 2 == 0 &&
+            version.compare_exchange_weak(current_version, current_version + 1, std::memory_order_acquire)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void PlayerSkipList::endWrite() {
+    if (num_of_retired >= SKIPLIST_RECLAIM_BATCH) {
+        reclaim();
+    }
+    publish(version, version.load(std::memory_order_relaxed) + 1);
+}
+
+void PlayerSkipList::retire(Node* node, bool chain, Histogram* hist) {
+    if (num_of_retired == retired_capacity) {
+        int new_capacity = retired_capacity ? 2 * retired_capacity : SKIPLIST_RECLAIM_BATCH;
+        Retired* new_retired = new Retired[new_capacity];
+        if (!new_retired) throw std::bad_alloc();
+        if (num_of_retired > 0) {
+            memcpy(new_retired, retired, num_of_retired * sizeof(Retired));
+        }
+        delete[] retired;
+        retired = new_retired;
+        retired_capacity = new_capacity;
+    }
+    Retired& entry = retired[num_of_retired++];
+    entry.node = node;
+    entry.chain = chain;
+    entry.hist = hist;
+    entry.epoch = epoch.load();
+}
+
+// starts a new epoch, and frees what was retired before the oldest reader started. a reader that takes its slot
+// after the fence reads the list without the retired memory, and a reader in an older epoch keeps it.
+void PlayerSkipList::reclaim() {
+    epoch.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    unsigned long oldest_epoch = ULONG_MAX;
+    for (int i = 0; i < SKIPLIST_MAX_READERS; i++) {
+        unsigned long reader_epoch = reader_epochs[i];
+        if (reader_epoch != 0) {
+            oldest_epoch = std::min(oldest_epoch, reader_epoch);
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < num_of_retired; i++) {
+        if (retired[i].epoch < oldest_epoch) {
+            freeRetired(retired[i]);
+        }
+        else {
+            retired[kept++] = retired[i];
+        }
+    }
+    num_of_retired = kept;
+}
+
+void PlayerSkipList::freeRetired(const Retired& entry) {
+    delete entry.hist;
+    Node* node = entry.node;
+    while (node != nullptr) {
+        Node* next = entry.chain ? nextOf(node, 0) : nullptr;
+        deleteNode(node);
+        node = next;
+    }
+}
+
+Histogram* PlayerSkipList::copyHist(const Histogram* hist) {
+    Histogram* copy = new Histogram(*hist);
+    if (!copy) throw std::bad_alloc();
+    return copy;
+}
+
+// links new_hist instead of hist, which readers may still be reading
+void PlayerSkipList::replaceHist(std::atomic<Histogram*>& hist, Histogram* new_hist) {
+    Histogram* old_hist = hist;
+    publish(hist, new_hist);
+    if (old_hist) {
+        retire(nullptr, false, old_hist);
+    }
+}
+
+void PlayerSkipList::clearList() {
+    WriteSection section(this);
+    clearNodes();
+}
+
+// retires all the nodes, in one chain
+void PlayerSkipList::clearNodes() {
+    Node* first = nextOf(header, 0);
+    clearHeaderFrom(0);
+    if (first) {
+        retire(first, true, nullptr);
+    }
+    publish(height, 1);
+    publish(size, 0);
+    publish(sum_of_levels, 0);
+    if (with_hists) {
+        Histogram* hist = new Histogram(scale);
+        if (!hist) throw std::bad_alloc();
+        replaceHist(score_hist, hist);
+    }
+}
+
+// a height of 1 + the amount of random draws in a row that hit 1/SKIPLIST_BRANCHING (xorshift32)
+int PlayerSkipList::randomHeight() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    unsigned int bits = random_state;
+    int node_height = 1;
+    while (node_height < SKIPLIST_MAX_HEIGHT && bits % SKIPLIST_BRANCHING == 0) {
+        node_height++;
+        bits /= SKIPLIST_BRANCHING;
+    }
+    return node_height;
+}
+
+PlayerSkipList::Node* PlayerSkipList::newNode(Player* player, int node_height) {
+    Node* node = new Node();
+    if (!node) throw std::bad_alloc();
+    node->links = new Link[node_height];
+    if (!node->links) throw std::bad_alloc();
+    node->key = player->getTreeKey();
+    node->level = player->getLevel();
+    node->score = player->getScore();
+    node->height = node_height;
+    node->player = player;
+    return node;
+}
+
+void PlayerSkipList::deleteNode(Node* node) {
+    for (int i = 0; i < node->height; i++) {
+        delete node->links[i].hist.load();
+    }
+    delete[] node->links;
+    delete node;
+}
+
+// empties the links of the header from level on
+void PlayerSkipList::clearHeaderFrom(int level) {
+    Node* first = header;
+    for (int i = level; i < SKIPLIST_MAX_HEIGHT; i++) {
+        Link& link = first->links[i];
+        publish(link.next, nullptr);
+        publish(link.span, 0);
+        publish(link.level_sum, 0);
+        replaceHist(link.hist, nullptr);
+    }
+}
+
+// finds the last node before key on every level in use. ranks[i] and level_sums[i] (if not nullptr) are the amount
+// of players up to update[i] and the sum of their levels. only for the writer.
+void PlayerSkipList::findPredecessors(long long key, Node** update, int* ranks, long* level_sums) const {
+    Node* node = header;
+    int rank = 0;
+    long level_sum = 0;
+    for (int i = height - 1; i >= 0; i--) {
+        Node* next = nextOf(node, i);
+        while (next != nullptr && next->key < key) {
+            rank += node->links[i].span;
+            level_sum += node->links[i].level_sum;
+            node = next;
+            next = nextOf(node, i);
+        }
+        update[i] = node;
+        if (ranks) {
+            ranks[i] = rank;
+            level_sums[i] = level_sum;
+        }
+    }
+}
+
+// a new histogram of the link of node on level (>= SKIPLIST_HIST_HEIGHT), computed from the level below it: from the
+// histograms of the links it covers, or from the scores of the nodes on the bottom level
+Histogram* PlayerSkipList::computeLinkHist(Node* node, int level) const {
+    Histogram* hist = new Histogram(scale);
+    if (!hist) throw std::bad_alloc();
+    Node* end = nextOf(node, level);
+    if (hasHist(level - 1)) {
+        for (Node* covered = node; covered != end; covered = nextOf(covered, level - 1)) {
+            *hist += *covered->links[level - 1].hist;
+        }
+        return hist;
+    }
+    for (Node* covered = nextOf(node, 0); covered != nullptr; covered = nextOf(covered, 0)) {
+        hist->increaseElement(covered->score - 1);
+        if (covered == end) {
+            break;
+        }
+    }
+    return hist;
+}
+
+ReturnValue PlayerSkipList::insert(Player* player) {
+    WriteSection section(this);
+    return insertNode(player);
+}
+
+ReturnValue PlayerSkipList::insertNode(Player* player) {
+    if (player == nullptr) {
+        return MY_INVALID_INPUT;
+    }
+    Node* update[SKIPLIST_MAX_HEIGHT];
+    int ranks[SKIPLIST_MAX_HEIGHT];
+    long level_sums[SKIPLIST_MAX_HEIGHT];
+    long long key = player->getTreeKey();
+    findPredecessors(key, update, ranks, level_sums);
+    Node* successor = nextOf(update[0], 0);
+    if (successor != nullptr && successor->key == key) {
+        return ELEMENT_EXISTS;
+    }
+
+    // new levels of the list start with a header link over all the players
+    Node* first = header;
+    int node_height = randomHeight();
+    for (int i = height; i < node_height; i++) {
+        update[i] = first;
+        ranks[i] = 0;
+        level_sums[i] = 0;
+        publish(first->links[i].span, size.load());
+        publish(first->links[i].level_sum, sum_of_levels.load());
+        if (hasHist(i)) {
+            replaceHist(first->links[i].hist, copyHist(score_hist));
+        }
+    }
+    publish(height, std::max(height.load(), node_height));
+
+    // the node takes over the part of each link it splits that comes after it, before it is linked in
+    Node* node = newNode(player, node_height);
+    for (int i = 0; i < node_height; i++) {
+        Link& prev_link = update[i]->links[i];
+        publish(node->links[i].next, nextOf(update[i], i));
+        publish(node->links[i].span, prev_link.span - (ranks[0] - ranks[i]));
+        publish(node->links[i].level_sum, prev_link.level_sum - (level_sums[0] - level_sums[i]));
+        if (hasHist(i)) {
+            publish(node->links[i].hist, computeLinkHist(node, i));
+        }
+    }
+
+    // the node is linked in bottom up. the bottom level is a CAS from the successor the search found, which holds as
+    // long as the writers take turns.
+    for (int i = 0; i < height; i++) {
+        Link& prev_link = update[i]->links[i];
+        Histogram* hist = prev_link.hist ? copyHist(prev_link.hist) : nullptr;
+        if (i < node_height) {
+            publish(prev_link.span, ranks[0] - ranks[i] + 1);
+            publish(prev_link.level_sum, level_sums[0] - level_sums[i] + node->level);
+            if (hist) {
+                *hist -= *node->links[i].hist;
+            }
+        }
+        else {
+            publish(prev_link.span, prev_link.span + 1);
+            publish(prev_link.level_sum, prev_link.level_sum + node->level);
+        }
+        if (hist) {
+            hist->increaseElement(node->score - 1);
+            replaceHist(prev_link.hist, hist);
+        }
+        if (i == 0) {
+            bool linked = prev_link.next.compare_exchange_strong(successor, node, std::memory_order_release);
+            assert(linked);
+            (void)linked;
+        }
+        else if (i < node_height) {
+            publish(prev_link.next, node);
+        }
+    }
+    publish(size, size + 1);
+    publish(sum_of_levels, sum_of_levels + node->level);
+    if (with_hists) {
+        Histogram* hist = copyHist(score_hist);
+        hist->increaseElement(node->score - 1);
+        replaceHist(score_hist, hist);
+    }
+    return MY_SUCCESS;
+}
+
+ReturnValue PlayerSkipList::remove(const Player& player) {
+    WriteSection section(this);
+    Node* update[SKIPLIST_MAX_HEIGHT];
+    long long key = player.getTreeKey();
+    findPredecessors(key, update, nullptr, nullptr);
+    Node* node = nextOf(update[0], 0);
+    if (node == nullptr || node->key != key) {
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+
+    // the links before the node take over its links, top down. the node keeps its own links, for the readers on it.
+    for (int i = height - 1; i >= 0; i--) {
+        Link& prev_link = update[i]->links[i];
+        Histogram* hist = prev_link.hist ? copyHist(prev_link.hist) : nullptr;
+        if (i < node->height) {
+            publish(prev_link.span, prev_link.span + node->links[i].span - 1);
+            publish(prev_link.level_sum, prev_link.level_sum + node->links[i].level_sum - node->level);
+            if (hist) {
+                *hist += *node->links[i].hist;
+            }
+            publish(prev_link.next, nextOf(node, i));
+        }
+        else {
+            publish(prev_link.span, prev_link.span - 1);
+            publish(prev_link.level_sum, prev_link.level_sum - node->level);
+        }
+        if (hist) {
+            hist->decreaseElement(node->score - 1);
+            replaceHist(prev_link.hist, hist);
+        }
+    }
+    publish(size, size - 1);
+    publish(sum_of_levels, sum_of_levels - node->level);
+    if (with_hists) {
+        Histogram* hist = copyHist(score_hist);
+        hist->decreaseElement(node->score - 1);
+        replaceHist(score_hist, hist);
+    }
+    retire(node, false, nullptr);
+    return MY_SUCCESS;
+}
+
+// moves the player from old_score to new_score. the link before the player on every level covers it.
+ReturnValue PlayerSkipList::updateScore(const Player& player, int old_score, int new_score) {
+    WriteSection section(this);
+    Node* update[SKIPLIST_MAX_HEIGHT];
+    long long key = player.getTreeKey();
+    findPredecessors(key, update, nullptr, nullptr);
+    Node* node = nextOf(update[0], 0);
+    if (node == nullptr || node->key != key) {
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+    publish(node->score, new_score);
+    for (int i = 0; i < height; i++) {
+        if (update[i]->links[i].hist) {
+            Histogram* hist = copyHist(update[i]->links[i].hist);
+            hist->decreaseElement(old_score - 1);
+            hist->increaseElement(new_score - 1);
+            replaceHist(update[i]->links[i].hist, hist);
+        }
+    }
+    if (with_hists) {
+        Histogram* hist = copyHist(score_hist);
+        hist->decreaseElement(old_score - 1);
+        hist->increaseElement(new_score - 1);
+        replaceHist(score_hist, hist);
+    }
+    return MY_SUCCESS;
+}
+
+// the readers below may see links of different versions before endRead turns them down, so they only rely on what
+// holds in every version: the links lead to higher keys (or nullptr), on levels the node they leave has
+
+Player* PlayerSkipList::getLowestPlayer() const {
+    Player* player;
+    readConsistent([&]() {
+        Node* node = nextOf(header, 0);
+        player = node ? node->player : nullptr;
+    });
+    return player;
+}
+
+Player* PlayerSkipList::getHighestPlayer() const {
+    Player* player;
+    readConsistent([&]() {
+        Node* node = header;
+        for (int i = height - 1; i >= 0; i--) {
+            for (Node* next = nextOf(node, i); next != nullptr; next = nextOf(node, i)) {
+                node = next;
+            }
+        }
+        player = node->player;
+    });
+    return player;
+}
+
+// the k-th lowest player (k = 1 for the lowest), or nullptr if there is no such player
+Player* PlayerSkipList::select(int k) const {
+    Player* player;
+    readConsistent([&]() {
+        player = nullptr;
+        if (k <= 0 || k > size) {
+            return;
+        }
+        Node* node = header;
+        int rank = 0;
+        for (int i = height - 1; i >= 0; i--) {
+            Node* next = nextOf(node, i);
+            while (next != nullptr && rank + node->links[i].span <= k) {
+                rank += node->links[i].span;
+                node = next;
+                next = nextOf(node, i);
+            }
+        }
+        player = node->player;
+    });
+    return player;
+}
+
+// the sum of the levels of the k lowest players
+long PlayerSkipList::sumOfLowestLevels(int k) const {
+    long level_sum;
+    readConsistent([&]() {
+        Node* node = header;
+        int rank = 0;
+        level_sum = 0;
+        for (int i = height - 1; i >= 0; i--) {
+            Node* next = nextOf(node, i);
+            while (next != nullptr && rank + node->links[i].span <= k) {
+                rank += node->links[i].span;
+                level_sum += node->links[i].level_sum;
+                node = next;
+                next = nextOf(node, i);
+            }
+        }
+    });
+    return level_sum;
+}
+
+// counts the players <= upper_bound, and how many of them have the given score. the scores are counted only by
+// lists with score histograms, and only if players_with_score isn't nullptr: the links are followed down to
+// SKIPLIST_HIST_HEIGHT, and the rest of the players are scanned on the bottom level.
+void PlayerSkipList::countUpTo(const Player& upper_bound, int score, int* players, int* players_with_score) const {
+    long long key = upper_bound.getTreeKey();
+    bool count_scores = with_hists && players_with_score != nullptr;
+    int lowest_level = count_scores ? SKIPLIST_HIST_HEIGHT : 0;
+    int count, with_score;
+    readConsistent([&]() {
+        count = 0;
+        with_score = 0;
+        Node* node = header;
+        for (int i = height - 1; i >= lowest_level; i--) {
+            Node* next = nextOf(node, i);
+            while (next != nullptr && next->key <= key) {
+                count += node->links[i].span;
+                const Histogram* hist = node->links[i].hist;
+                if (count_scores && hist) {
+                    with_score += hist->getVal(score - 1);
+                }
+                node = next;
+                next = nextOf(node, i);
+            }
+        }
+        if (!count_scores) {
+            return;
+        }
+        for (Node* next = nextOf(node, 0); next != nullptr && next->key <= key; next = nextOf(next, 0)) {
+            count++;
+            with_score += (next->score == score);
+        }
+    });
+    *players = count;
+    if (players_with_score) {
+        *players_with_score = with_score;
+    }
+}
+
+// the amount of players with the given score. only for lists with score histograms.
+int PlayerSkipList::countWithScore(int score) const {
+    int with_score;
+    readConsistent([&]() {
+        const Histogram* hist = score_hist;
+        with_score = hist ? hist->getVal(score - 1) : 0;
+    });
+    return with_score;
+}
+
+void PlayerSkipList::appendPlayersTo(Player** players, int* count) const {
+    for (Node* node = nextOf(header, 0); node != nullptr; node = nextOf(node, 0)) {
+        players[(*count)++] = node->player;
+    }
+}
+
+void PlayerSkipList::appendNodesTo(Node** nodes, int* count) const {
+    for (Node* node = nextOf(header, 0); node != nullptr; node = nextOf(node, 0)) {
+        nodes[(*count)++] = node;
+    }
+}
+
+// relinks the list from sorted nodes, which keep their heights, and recomputes the aggregates of all the links
+void PlayerSkipList::linkSortedNodes(Node** nodes, int count) {
+    clearHeaderFrom(0);
+    int list_height = 1;
+    for (int i = 0; i < count; i++) {
+        list_height = std::max(list_height, nodes[i]->height);
+    }
+    publish(height, list_height);
+
+    // last[i] is the last node linked on level i so far, after last_ranks[i] players of level sum last_level_sums[i]
+    Node* last[SKIPLIST_MAX_HEIGHT];
+    int last_ranks[SKIPLIST_MAX_HEIGHT];
+    long last_level_sums[SKIPLIST_MAX_HEIGHT];
+    for (int i = 0; i < list_height; i++) {
+        last[i] = header;
+        last_ranks[i] = 0;
+        last_level_sums[i] = 0;
+    }
+    int list_size = 0;
+    long level_sum = 0;
+    for (int j = 0; j < count; j++) {
+        Node* node = nodes[j];
+        list_size++;
+        level_sum += node->level;
+        for (int i = 0; i < node->height; i++) {
+            Link& link = last[i]->links[i];
+            publish(link.next, node);
+            publish(link.span, list_size - last_ranks[i]);
+            publish(link.level_sum, level_sum - last_level_sums[i]);
+            last[i] = node;
+            last_ranks[i] = list_size;
+            last_level_sums[i] = level_sum;
+        }
+    }
+    for (int i = 0; i < list_height; i++) {
+        Link& link = last[i]->links[i];
+        publish(link.next, nullptr);
+        publish(link.span, list_size - last_ranks[i]);
+        publish(link.level_sum, level_sum - last_level_sums[i]);
+    }
+    publish(size, list_size);
+    publish(sum_of_levels, level_sum);
+    if (!with_hists) {
+        return;
+    }
+
+    Histogram* hist = new Histogram(scale);
+    if (!hist) throw std::bad_alloc();
+    for (int j = 0; j < count; j++) {
+        hist->increaseElement(nodes[j]->score - 1);
+    }
+    replaceHist(score_hist, hist);
+    for (int i = SKIPLIST_HIST_HEIGHT; i < list_height; i++) {
+        for (Node* node = header; node != nullptr; node = nextOf(node, i)) {
+            replaceHist(node->links[i].hist, computeLinkHist(node, i));
+        }
+    }
+}
+
+// swaps the players of the 2 lists (of the same scale)
+void PlayerSkipList::swapPlayers(PlayerSkipList& other_list) {
+    swapPublished(header, other_list.header);
+    swapPublished(height, other_list.height);
+    swapPublished(size, other_list.size);
+    swapPublished(sum_of_levels, other_list.sum_of_levels);
+    swapPublished(score_hist, other_list.score_hist);
+}
+
+// a skiplist merge is by insertion or by relinking all the nodes (as a rebuild), never by union
+MergePath PlayerSkipList::chooseMergePath(int small_size, int large_size) {
+    return ((long)small_size * SKIPLIST_MERGE_INSERTION_RATIO <= large_size) ? MERGE_BY_INSERTION : MERGE_BY_REBUILD;
+}
+
+// moves all the players of other_list to this list, and leaves other_list empty. a merge by insertion inserts the
+// players of the smaller list into the bigger one. a rebuild merges the nodes of both lists in order and relinks them,
+// so no node is allocated.
+// both lists are written, so the merge takes the turn of a writer in each, in the order of their addresses (2 merges
+// of the same lists in opposite directions can't wait for each other)
+void PlayerSkipList::mergeListToMe(PlayerSkipList& other_list) {
+    WriteSection first_section(this < &other_list ? this : &other_list);
+    WriteSection second_section(this < &other_list ? &other_list : this);
+    if (other_list.size == 0) {
+        return;
+    }
+    if (size < other_list.size) {
+        swapPlayers(other_list);
+    }
+    int this_size = size, other_size = other_list.size;
+    MergePath path = chooseMergePath(other_size, this_size);
+    merge_counters.merges[path]++;
+    if (path == MERGE_BY_INSERTION) {
+        Player** other_players = new Player*[other_size];
+        if (!other_players) throw std::bad_alloc();
+        int count = 0;
+        other_list.appendPlayersTo(other_players, &count);
+        other_list.clearNodes();
+        for (int i = 0; i < count; i++) {
+            insertNode(other_players[i]);
+        }
+        delete[] other_players;
+        return;
+    }
+
+    Node** this_nodes = new Node*[this_size];
+    Node** other_nodes = new Node*[other_size];
+    Node** merged_nodes = new Node*[this_size + other_size];
+    if (!this_nodes || !other_nodes || !merged_nodes) throw std::bad_alloc();
+    int count = 0;
+    appendNodesTo(this_nodes, &count);
+    count = 0;
+    other_list.appendNodesTo(other_nodes, &count);
+    std::merge(this_nodes, this_nodes + this_size, other_nodes, other_nodes + other_size, merged_nodes,
+               [](const Node* node1, const Node* node2) { return node1->key < node2->key; });
+    linkSortedNodes(merged_nodes, this_size + other_size);
+
+    // the nodes of other_list are owned by this list now
+    other_list.clearHeaderFrom(0);
+    publish(other_list.height, 1);
+    publish(other_list.size, 0);
+    publish(other_list.sum_of_levels, 0);
+    if (with_hists) {
+        Histogram* hist = new Histogram(scale);
+        if (!hist) throw std::bad_alloc();
+        other_list.replaceHist(other_list.score_hist, hist);
+    }
+    delete[] this_nodes;
+    delete[] other_nodes;
+    delete[] merged_nodes;
+}
@@ -0,0 +1,172 @@
+#ifndef WET2_PLAYER_SKIPLIST_H
+#define WET2_PLAYER_SKIPLIST_H
+
+#include <atomic>
+#include "player.h"
+#include "histogram.h"
+#include "rank_tree.h"
+
+// a node is on level i + 1 of the list with probability 1/SKIPLIST_BRANCHING, given it is on level i.
+// the links of levels SKIPLIST_HIST_HEIGHT and up keep score histograms, so about 1 node in
+// SKIPLIST_BRANCHING^SKIPLIST_HIST_HEIGHT has any.
+#define SKIPLIST_BRANCHING 4
+#define SKIPLIST_MAX_HEIGHT 16
+#define SKIPLIST_HIST_HEIGHT 2
+
+// a merge inserts the players of the smaller list one by one while it has at most 1/SKIPLIST_MERGE_INSERTION_RATIO of
+// the players of the bigger list, and relinks the nodes of both lists otherwise. relinking recomputes every link, and
+// with 200000 players it took longer than the insertions up to m = 100000.
+#define SKIPLIST_MERGE_INSERTION_RATIO 2
+
+// a reader holds one of SKIPLIST_MAX_READERS slots (of all the lists) while it reads, and the nodes and histograms the
+// writers removed are freed once every reader that might still reach them has left its slot. a writer looks for such
+// memory after every SKIPLIST_RECLAIM_BATCH removals.
+#define SKIPLIST_MAX_READERS 64
+#define SKIPLIST_RECLAIM_BATCH 64
+
+// the players with level > 0 of a group, in a skiplist ordered by (level, id). an alternative to the players
+// RankTree of a group (see GroupTreeType in group_index.h), with the same counting queries.
+// every link keeps the aggregates of the nodes it skips over (from the node after it up to the node it links to):
+// the amount of them, the sum of their levels, and on the upper levels their score histogram. a count of the scores
+// skips on the upper links, and scans the bottom level for the rest.
+//
+// the queries may run in other threads than the updates, and take no lock. a query reads the list as of its version,
+// and runs again if a writer changed the version meanwhile (it is odd while the list is written). an update changes
+// the aggregates of every link on its path, so the writers of a list take turns: a writer takes its turn by making
+// the version odd with a CAS. a node is linked in bottom up, the bottom level with a CAS, and unlinked top down. the
+// histogram of a published link is never changed: a writer links an updated copy instead. the nodes and histograms a
+// writer removes are retired, and freed once no reader that started before the removal is still reading (by epochs).
+class PlayerSkipList {
+    struct Node;
+    struct Link {
+        std::atomic<Node*> next;
+        std::atomic<int> span;          // the nodes in (this node, next], or up to the end of the list when next
+                                        // is nullptr
+        std::atomic<long> level_sum;    // the sum of their levels
+        std::atomic<Histogram*> hist;   // their scores, or nullptr below SKIPLIST_HIST_HEIGHT (or without histograms)
+
+        Link() : next(nullptr), span(0), level_sum(0), hist(nullptr) {}
+    };
+    struct Node {
+        long long key;      // Player::getTreeKey()
+        int level;
+        std::atomic<int> score;
+        int height;
+        Player* player;
+        Link* links;        // height links, links[i] is the link of level i
+    };
+    // a removed node, a chain of removed nodes on the bottom level (up to nullptr), or a replaced histogram
+    struct Retired {
+        Node* node;
+        bool chain;
+        Histogram* hist;
+        unsigned long epoch;    // the epoch it was removed in
+    };
+    // a reader slot, held for one query
+    class ReadSection {
+        int slot;
+    public:
+        ReadSection();
+        ~ReadSection();
+        ReadSection(const ReadSection& other_section) = delete;
+        ReadSection& operator=(const ReadSection& other_section) = delete;
+    };
+    // the turn of a writer of the list, for one update
+    class WriteSection {
+        PlayerSkipList* list;
+    public:
+        explicit WriteSection(PlayerSkipList* list) : list(list) { list->beginWrite(); }
+        ~WriteSection() { list->endWrite(); }
+        WriteSection(const WriteSection& other_section) = delete;
+        WriteSection& operator=(const WriteSection& other_section) = delete;
+    };
+
+    std::atomic<Node*> header;          // a node of SKIPLIST_MAX_HEIGHT links, before the first player
+    std::atomic<int> height;            // the amount of levels in use
+    std::atomic<int> size;
+    std::atomic<long> sum_of_levels;
+    int scale;
+    bool with_hists;
+    std::atomic<Histogram*> score_hist; // the scores of all the players, or nullptr without histograms
+    std::atomic<unsigned int> version;
+    // the rest is only touched by the writer
+    unsigned int random_state;
+    Retired* retired;
+    int num_of_retired;
+    int retired_capacity;
+
+    // the epoch of the writers, and the epoch every reader slot was taken in (0 for a free slot)
+    static std::atomic<unsigned long> epoch;
+    static std::atomic<unsigned long> reader_epochs[SKIPLIST_MAX_READERS];
+
+    // the stores of the writer are release stores, and the loads (the conversions of the atomics) are sequentially
+    // consistent, so a reader that sees a store sees everything written before it, the odd version included
+    template <class T, class U>
+    static void publish(std::atomic<T>& field, U value) { field.store(value, std::memory_order_release); }
+    template <class T>
+    static void swapPublished(std::atomic<T>& field1, std::atomic<T>& field2) {
+        T value = field1;
+        publish(field1, field2.load());
+        publish(field2, value);
+    }
+    static Node* nextOf(const Node* node, int level) { return node->links[level].next; }
+    bool hasHist(int level) const { return with_hists && level >= SKIPLIST_HIST_HEIGHT; }
+    unsigned int beginRead() const;
+    bool endRead(unsigned int start_version) const;
+    // runs read until no writer changed the list while it ran
+    template <class Read>
+    void readConsistent(Read read) const {
+        ReadSection section;
+        unsigned int start_version;
+        do {
+            start_version = beginRead();
+            read();
+        } while (!endRead(start_version));
+    }
+    void beginWrite();
+    void endWrite();
+    void retire(Node* node, bool chain, Histogram* hist);
+    void reclaim();
+    static void freeRetired(const Retired& entry);
+    static Histogram* copyHist(const Histogram* hist);
+    void replaceHist(std::atomic<Histogram*>& hist, Histogram* new_hist);
+    int randomHeight();
+    Node* newNode(Player* player, int node_height);
+    static void deleteNode(Node* node);
+    void clearHeaderFrom(int level);
+    void clearNodes();
+    void findPredecessors(long long key, Node** update, int* ranks, long* level_sums) const;
+    Histogram* computeLinkHist(Node* node, int level) const;
+    ReturnValue insertNode(Player* player);
+    void appendNodesTo(Node** nodes, int* count) const;
+    void linkSortedNodes(Node** nodes, int count);
+    void swapPlayers(PlayerSkipList& other_list);
+    static MergePath chooseMergePath(int small_size, int large_size);
+    static MergeCounters merge_counters;
+
+public:
+    PlayerSkipList(int scale, bool with_hists);
+    ~PlayerSkipList();
+    PlayerSkipList(const PlayerSkipList& other_list) = delete;
+    PlayerSkipList& operator=(const PlayerSkipList& other_list) = delete;
+
+    int getSize() const { return size; }
+    long getSumOfLevels() const { return sum_of_levels; }
+    void clearList();
+    ReturnValue insert(Player* player);
+    ReturnValue remove(const Player& player);
+    ReturnValue updateScore(const Player& player, int old_score, int new_score);
+    Player* getLowestPlayer() const;
+    Player* getHighestPlayer() const;
+    Player* select(int k) const;
+    long sumOfLowestLevels(int k) const;
+    void countUpTo(const Player& upper_bound, int score, int* players, int* players_with_score) const;
+    int countWithScore(int score) const;
+    void mergeListToMe(PlayerSkipList& other_list);
+    // only for the writer of the list: it isn't run again if the list changes under it
+    void appendPlayersTo(Player** players, int* count) const;
+    static const MergeCounters& getMergeCounters() { return merge_counters; }
+    static void resetMergeCounters() { merge_counters = MergeCounters(); }
+};
+
+#endif //WET2_PLAYER_SKIPLIST_H
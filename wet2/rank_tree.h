@@ -8,12 +8,28 @@
 typedef enum {MY_ALLOCATION_ERROR, MY_INVALID_INPUT, MY_FAILURE, MY_SUCCESS, ELEMENT_EXISTS,
     ELEMENT_DOES_NOT_EXIST, NO_ELEMENT_INSERT_LEFT, NO_ELEMENT_INSERT_RIGHT, NO_ROOT} ReturnValue;
 
+// the ways to merge 2 trees (or hash tables) of sizes m <= n
+typedef enum {MERGE_BY_INSERTION, MERGE_BY_UNION, MERGE_BY_REBUILD, NUM_OF_MERGE_PATHS} MergePath;
+
+// how many merges took each path, for checking the merge cost models against real merge sizes
+typedef struct {
+    long merges[NUM_OF_MERGE_PATHS];
+} MergeCounters;
+
 using std::ostream;
 
 template<typename data_t, typename rank_t>
 class RankTree {
     RankTreeNode<data_t, rank_t>* root;
+    RankTreeNode<data_t, rank_t>* min_node; // the ends of the in-order threads (prev/next) of the nodes
+    RankTreeNode<data_t, rank_t>* max_node;
     int size;
+    int hist_threshold; // only ranks of sub_trees with more than hist_threshold nodes hold a score histogram
+
+    //In-Order Threads
+    void linkAfter(RankTreeNode<data_t, rank_t>* prev_node, RankTreeNode<data_t, rank_t>* node);
+    void unlinkNode(RankTreeNode<data_t, rank_t>* node);
+    static RankTreeNode<data_t, rank_t>* treePredecessor(RankTreeNode<data_t, rank_t>* node);
 
     //Tree Rolls
     ReturnValue fixTree(RankTreeNode<data_t, rank_t>* node);
@@ -24,67 +40,107 @@ class RankTree {
     ReturnValue RLRoll(RankTreeNode<data_t, rank_t>* node);
 
     //Node Removal Helper Functions
-    ReturnValue removeRoot(RankTreeNode<data_t, rank_t>* node);
-    ReturnValue removeNonRoot(RankTreeNode<data_t, rank_t>* node);
+    ReturnValue detachRoot(RankTreeNode<data_t, rank_t>* node);
+    ReturnValue detachNonRoot(RankTreeNode<data_t, rank_t>* node);
 
     //Node Swaps
     void swapNodes(RankTreeNode<data_t, rank_t>* node1, RankTreeNode<data_t, rank_t>* node2);
     void swapRoot(RankTreeNode<data_t, rank_t>* received_root, RankTreeNode<data_t, rank_t>* node);
     void swapNonRoot(RankTreeNode<data_t, rank_t>* node1, RankTreeNode<data_t, rank_t>* node2);
 
-    //Tree Merging Helper Function and Calculations
-    static int findRequiredEmptyTreeHeight(int tree_size);
-    static int findNumOfNodesToDelete(int tree_size);
-    static RankTreeNode<data_t, rank_t>* createEmptyTree(int* height, int scale);
-    static bool removeExtraTreeNodes(RankTreeNode<data_t, rank_t>* node, int* num_of_nodes_to_delete, int* tree_height);
-
-    //Array Casting
-    static void putTreeToArray(RankTreeNode<data_t, rank_t>* node, RankTreeNode<data_t, rank_t>* array[], int* i);
-    static void putArrayIntoTree(RankTreeNode<data_t, rank_t>** node, RankTreeNode<data_t, rank_t>*** array, int* i);
-
-    //Array Merging
-    static void mergeArrays(RankTreeNode<data_t, rank_t>* arr1[], RankTreeNode<data_t, rank_t>* arr2[],
-                            RankTreeNode<data_t, rank_t>* merged_arr[], int arr1_size, int arr2_size);
-
-    // Tree rank update functions
-    void fullTreeRankUpdate();
-    void recursiveRankUpdate(RankTreeIterator<data_t, rank_t> *iter);
+    //Tree Merging Helper Functions
+    static RankTreeNode<data_t, rank_t>* threadsToList(RankTreeNode<data_t, rank_t>* first_node);
+    static RankTreeNode<data_t, rank_t>* mergeLists(RankTreeNode<data_t, rank_t>* list1,
+                                                    RankTreeNode<data_t, rank_t>* list2);
+    RankTreeNode<data_t, rank_t>* buildTreeFromList(RankTreeNode<data_t, rank_t>** list, int num_of_nodes);
+    MergePath chooseMergePath(int small_size, int large_size);
+    static MergeCounters merge_counters;
+
+    //Join, Split and Union (on sub_trees that aren't attached to a father)
+    static int nodeHeight(RankTreeNode<data_t, rank_t>* node);
+    RankTreeNode<data_t, rank_t>* linkNode(RankTreeNode<data_t, rank_t>* left, RankTreeNode<data_t, rank_t>* node,
+                                           RankTreeNode<data_t, rank_t>* right);
+    RankTreeNode<data_t, rank_t>* rotateLeft(RankTreeNode<data_t, rank_t>* node);
+    RankTreeNode<data_t, rank_t>* rotateRight(RankTreeNode<data_t, rank_t>* node);
+    RankTreeNode<data_t, rank_t>* joinRight(RankTreeNode<data_t, rank_t>* left, RankTreeNode<data_t, rank_t>* middle,
+                                            RankTreeNode<data_t, rank_t>* right);
+    RankTreeNode<data_t, rank_t>* joinLeft(RankTreeNode<data_t, rank_t>* left, RankTreeNode<data_t, rank_t>* middle,
+                                           RankTreeNode<data_t, rank_t>* right);
+    RankTreeNode<data_t, rank_t>* joinNodes(RankTreeNode<data_t, rank_t>* left, RankTreeNode<data_t, rank_t>* middle,
+                                            RankTreeNode<data_t, rank_t>* right);
+    RankTreeNode<data_t, rank_t>* splitNodes(RankTreeNode<data_t, rank_t>* node, long long key,
+                                             RankTreeNode<data_t, rank_t>** left, RankTreeNode<data_t, rank_t>** right);
+    RankTreeNode<data_t, rank_t>* unionNodes(RankTreeNode<data_t, rank_t>* node1, RankTreeNode<data_t, rank_t>* node2);
 
 public:
 
 
-    RankTree() : size(0), root(nullptr) {}
+    explicit RankTree(int hist_threshold = 0) : root(nullptr), min_node(nullptr), max_node(nullptr), size(0),
+                                                hist_threshold(hist_threshold) {}
     ~RankTree();
     void clearTree();
 
     int getSize() const { return size; }
     ReturnValue find(data_t data, RankTreeNode<data_t, rank_t>** node_find);
-    ReturnValue insert(data_t* data, int scale);
+    ReturnValue insert(data_t* data, int scale, RankTreeNode<data_t, rank_t>** inserted_node = nullptr);
+    ReturnValue insertNode(RankTreeNode<data_t, rank_t>* node_to_insert);
     ReturnValue remove(data_t data);
-    void mergeTreeToMe(RankTree<data_t, rank_t>& other_tree, int scale);
+
+    // the handle API: the node returned by insert stays valid (and holds the same data) until it is removed, also
+    // through rotations, removals of other nodes and merges. these functions don't search the tree for the node.
+    ReturnValue removeNode(RankTreeNode<data_t, rank_t>* node);
+    ReturnValue rekeyNode(RankTreeNode<data_t, rank_t>* node, const data_t& old_data);
+    void mergeTreeToMe(RankTree<data_t, rank_t>& other_tree);
+    ReturnValue join(data_t* middle, RankTree<data_t, rank_t>& right_tree, int scale);
+    void split(const data_t& key, RankTree<data_t, rank_t>& right_tree);
+    void unionTreeToMe(RankTree<data_t, rank_t>& other_tree);
+    void insertTreeToMe(RankTree<data_t, rank_t>& other_tree);
+    void rebuildTreeToMe(RankTree<data_t, rank_t>& other_tree);
+    static const MergeCounters& getMergeCounters() { return merge_counters; }
+    static void resetMergeCounters() { merge_counters = MergeCounters(); }
     RankTreeIterator<data_t, rank_t> begin();
+    RankTreeIterator<data_t, rank_t> first() { return RankTreeIterator<data_t, rank_t>(min_node); }
+    RankTreeIterator<data_t, rank_t> last() { return RankTreeIterator<data_t, rank_t>(max_node); }
 
     //Rank functions
     void updateRankAlongPath(RankTreeNode<data_t, rank_t>* node);
-
-    // functions for getting highest/lowest level players from tree
-    RankTreeNode<data_t, rank_t>* getLeftMostNode();
-    RankTreeNode<data_t, rank_t>* getRightMostNode();
+    void updateScoreAlongPath(RankTreeNode<data_t, rank_t>* node, int old_score, int new_score);
+    void addToRankAlongPath(RankTreeNode<data_t, rank_t>* node, data_t data);
+    void removeFromRankAlongPath(RankTreeNode<data_t, rank_t>* node, data_t data);
+
+    // order statistics, each in one walk down from the root
+    RankTreeNode<data_t, rank_t>* select(int k);
+    int rankOf(const data_t& key);
+    RankTreeIterator<data_t, rank_t> lowerBound(const data_t& key);
+    void prefixAggregate(const data_t& key, rank_t* total);
+    void prefixAggregateByCount(int k, rank_t* total);
+
+    // functions for getting highest/lowest level players from tree, O(1). from there, the getNext/getPrev of the
+    // nodes step over the tree in order, O(1) per step.
+    RankTreeNode<data_t, rank_t>* getLeftMostNode() { return min_node; }
+    RankTreeNode<data_t, rank_t>* getRightMostNode() { return max_node; }
 };
 
+template<typename data_t, typename rank_t>
+MergeCounters RankTree<data_t, rank_t>::merge_counters = MergeCounters();
+
 // public class functions
 template<typename data_t, typename rank_t>
 RankTree<data_t, rank_t>::~RankTree(){
-    RankTreeNode<data_t, rank_t>::recursiveNodeDeletion(root);
+    RankTreeNode<data_t, rank_t>::deleteSubtree(root);
     root = nullptr;
+    min_node = nullptr;
+    max_node = nullptr;
     size = 0;
 }
 
 // this doesn't delete the tree, but it deletes all tree nodes ane resets the root to nullptr.
 template<typename data_t, typename rank_t>
 void RankTree<data_t, rank_t>::clearTree(){
-    RankTreeNode<data_t, rank_t>::recursiveNodeDeletion(root);
+    RankTreeNode<data_t, rank_t>::deleteSubtree(root);
     root = nullptr;
+    min_node = nullptr;
+    max_node = nullptr;
     size = 0;
 }
 
@@ -94,36 +150,44 @@ ReturnValue RankTree<data_t, rank_t>::find(data_t data, RankTreeNode<data_t, ran
         return NO_ROOT;
     }
 
-    RankTreeIterator<data_t, rank_t> iter = begin();
-
-    while(iter.node_ptr) {
-        *node_find = iter.node_ptr;
-        if (iter.getData() == data) {
+    long long key = data.getTreeKey();
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node) {
+        *node_find = node;
+        if (node->key == key) {
             return ELEMENT_EXISTS;
-        } else if (iter.getData() > data) {
-            iter.goLeft();
-        } else {
-            iter.goRight();
         }
+        node = (key < node->key) ? node->left : node->right;
     }
 
-    if(*((*node_find)->getData()) > data){
+    if(key < (*node_find)->key){
         return NO_ELEMENT_INSERT_LEFT;
     }
     return NO_ELEMENT_INSERT_RIGHT;
 }
 
 template<typename data_t, typename rank_t>
-ReturnValue RankTree<data_t, rank_t>::insert(data_t* data, int scale){
+ReturnValue RankTree<data_t, rank_t>::insert(data_t* data, int scale, RankTreeNode<data_t, rank_t>** inserted_node){
     RankTreeNode<data_t, rank_t>* node_to_insert = new RankTreeNode<data_t, rank_t>(data, scale);
     if(!node_to_insert){
         return MY_ALLOCATION_ERROR;
     }
+    ReturnValue res = insertNode(node_to_insert);
+    if(res == MY_SUCCESS && inserted_node != nullptr){
+        *inserted_node = node_to_insert;
+    }
+    return res;
+}
 
+// inserts a node that isn't in any tree (no father and no sons)
+template<typename data_t, typename rank_t>
+ReturnValue RankTree<data_t, rank_t>::insertNode(RankTreeNode<data_t, rank_t>* node_to_insert){
+    data_t* data = node_to_insert->data;
     if(!root){
         size++;
         root = node_to_insert;
-        node_to_insert->updateRank();
+        linkAfter(nullptr, node_to_insert);
+        node_to_insert->updateRank(hist_threshold);
         return MY_SUCCESS;
     }
 
@@ -137,16 +201,21 @@ ReturnValue RankTree<data_t, rank_t>::insert(data_t* data, int scale){
         case NO_ROOT :
             size++;
             root = node_to_insert;
+            linkAfter(nullptr, node_to_insert);
             return MY_SUCCESS;
         case ELEMENT_EXISTS :
             return MY_FAILURE;
         case NO_ELEMENT_INSERT_LEFT :
+            // a new left son comes right before its father in order
             node_find->left = node_to_insert;
             node_to_insert->father = node_find;
+            linkAfter(node_find->prev, node_to_insert);
             break;
         case NO_ELEMENT_INSERT_RIGHT :
+            // a new right son comes right after its father in order
             node_find->right = node_to_insert;
             node_to_insert->father = node_find;
+            linkAfter(node_find, node_to_insert);
         default :
             break;
     }
@@ -154,8 +223,10 @@ ReturnValue RankTree<data_t, rank_t>::insert(data_t* data, int scale){
     // increase num of nodes in tree
     size++;
 
+    // the new node holds only its own data, and every node above it gains exactly that data.
     // fix tree after insertion of new_node, starting at the father of new_node.
-    RankTree<data_t, rank_t>::updateRankAlongPath(node_to_insert);
+    node_to_insert->updateRank(hist_threshold);
+    RankTree<data_t, rank_t>::addToRankAlongPath(node_find, *data);
     return fixTree(node_find);
 }
 
@@ -174,83 +245,202 @@ ReturnValue RankTree<data_t, rank_t>::remove(data_t data) {
         default:
             return MY_FAILURE;
     }
-    if(node_find == root){
-        return removeRoot(node_find);
+
+    return removeNode(node_find);
+}
+
+// removes node from the tree and deletes it
+template<typename data_t, typename rank_t>
+ReturnValue RankTree<data_t, rank_t>::removeNode(RankTreeNode<data_t, rank_t>* node) {
+    // node is the one that is detached (swapNodes moves nodes, not datas), so unlink it before the removal
+    unlinkNode(node);
+    ReturnValue res = (node == root) ? detachRoot(node) : detachNonRoot(node);
+    delete node;
+    return res;
+}
+
+// moves node to its place by its data, after the key of its data changed in place (old_data holds the data as it was
+// inserted). the ranks on the path of node are moved from old_data to the new data first, so node can be detached by
+// its current data. if the new key is still between the keys of its in-order neighbours, node stays where it is.
+template<typename data_t, typename rank_t>
+ReturnValue RankTree<data_t, rank_t>::rekeyNode(RankTreeNode<data_t, rank_t>* node, const data_t& old_data) {
+    for (RankTreeNode<data_t, rank_t>* path_node = node; path_node != nullptr; path_node = path_node->father){
+        path_node->rank.removePlayer(old_data);
+        path_node->rank.addPlayer(*node->data);
     }
-    else{
-        return removeNonRoot(node_find);
+    node->key = node->data->getTreeKey();
+    if ((node->prev == nullptr || node->prev->key < node->key) &&
+        (node->next == nullptr || node->key < node->next->key)){
+        return MY_SUCCESS;
+    }
+
+    unlinkNode(node);
+    ReturnValue res = (node == root) ? detachRoot(node) : detachNonRoot(node);
+    if (res != MY_SUCCESS){
+        return res;
     }
+    node->father = nullptr;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->height = 0;
+    return insertNode(node);
 }
 
+// moves all the nodes of other_tree to this tree, and leaves other_tree empty. the nodes themselves are kept (only
+// their pointers change), so pointers to nodes stay valid.
+// by the sizes of the trees (see chooseMergePath), the nodes of the smaller tree are inserted one by one, or the trees
+// are united by join and split, or both are rebuilt into one balanced tree.
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::mergeTreeToMe(RankTree<data_t, rank_t>& other_tree, int scale){
+void RankTree<data_t, rank_t>::mergeTreeToMe(RankTree<data_t, rank_t>& other_tree){
 
     if (other_tree.size == 0){
         return;
     }
 
-    // create 2 empty arrays with matching size of trees
-    RankTreeNode<data_t, rank_t>** array1 = new RankTreeNode<data_t, rank_t>*[size];
-    RankTreeNode<data_t, rank_t>** array2 = new RankTreeNode<data_t, rank_t>*[other_tree.size];
-
-    // create array for merged tree
-    int merged_size = (size + other_tree.size);
-    RankTreeNode<data_t, rank_t>** merged_array = new RankTreeNode<data_t, rank_t>*[merged_size];
+    MergePath path = chooseMergePath(std::min(size, other_tree.size), std::max(size, other_tree.size));
+    merge_counters.merges[path]++;
+    if (path == MERGE_BY_INSERTION){
+        insertTreeToMe(other_tree);
+        return;
+    }
+    if (path == MERGE_BY_UNION){
+        unionTreeToMe(other_tree);
+        return;
+    }
+    rebuildTreeToMe(other_tree);
+}
 
-    // insert tree nodes to arrays
-    int i=0 , j = 0;
-    RankTree<data_t, rank_t>::putTreeToArray(root, array1, &i);
-    RankTree<data_t, rank_t>::putTreeToArray(other_tree.root, array2, &j);
+// moves all the nodes of other_tree to this tree, and leaves other_tree empty. both trees are linked into sorted lists,
+// the lists are merged, and a balanced tree is built from the merged list. O(n + m).
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::rebuildTreeToMe(RankTree<data_t, rank_t>& other_tree){
+    RankTreeNode<data_t, rank_t>* list1 = RankTree<data_t, rank_t>::threadsToList(min_node);
+    RankTreeNode<data_t, rank_t>* list2 = RankTree<data_t, rank_t>::threadsToList(other_tree.min_node);
+    RankTreeNode<data_t, rank_t>* merged_list = RankTree<data_t, rank_t>::mergeLists(list1, list2);
+
+    // thread the nodes in the order of the merged list
+    RankTreeNode<data_t, rank_t>* prev_node = nullptr;
+    for (RankTreeNode<data_t, rank_t>* node = merged_list; node != nullptr; node = node->right){
+        node->prev = prev_node;
+        node->next = nullptr;
+        if (prev_node != nullptr){
+            prev_node->next = node;
+        }
+        prev_node = node;
+    }
+    this->min_node = merged_list;
+    this->max_node = prev_node;
 
-    // merge arrays
-    RankTree<data_t, rank_t>::mergeArrays(array1, array2, merged_array, size, other_tree.size);
+    this->size += other_tree.size;
+    this->root = buildTreeFromList(&merged_list, size);
 
-    // create new empty tree with correct amount of nodes
-    int merged_tree_height = RankTree<data_t, rank_t>::findRequiredEmptyTreeHeight(merged_size);
-    RankTreeNode<data_t, rank_t>* future_root = RankTree<data_t, rank_t>::createEmptyTree( &merged_tree_height, scale);
+    other_tree.root = nullptr;
+    other_tree.min_node = nullptr;
+    other_tree.max_node = nullptr;
+    other_tree.size = 0;
+}
 
-    int num_of_nodes_to_delete = RankTree<data_t, rank_t>::findNumOfNodesToDelete(merged_size);
-    RankTree<data_t, rank_t>::removeExtraTreeNodes(future_root, &num_of_nodes_to_delete, &merged_tree_height);
+// joins this tree, middle and right_tree into this tree, and leaves right_tree empty. all the data in this tree must be
+// smaller than middle, and all the data in right_tree bigger. O(log n) (the difference of the tree heights).
+template<typename data_t, typename rank_t>
+ReturnValue RankTree<data_t, rank_t>::join(data_t* middle, RankTree<data_t, rank_t>& right_tree, int scale){
+    RankTreeNode<data_t, rank_t>* middle_node = new RankTreeNode<data_t, rank_t>(middle, scale);
+    if(!middle_node){
+        return MY_ALLOCATION_ERROR;
+    }
 
-    // insert nodes from merged array to empty tree
-    int m=0;
-    RankTree<data_t, rank_t>::putArrayIntoTree(&future_root, &merged_array, &m);
-    this->size = merged_size;
-    RankTreeNode<data_t, rank_t>* old_root = this->root;
-    RankTreeNode<data_t,rank_t>::recursiveNodeDeletion(old_root);
-    this->root = future_root;
-    this->fullTreeRankUpdate();
+    // middle goes between the max of this tree and the min of right_tree
+    middle_node->prev = max_node;
+    middle_node->next = right_tree.min_node;
+    if (max_node != nullptr){
+        max_node->next = middle_node;
+    }
+    else {
+        min_node = middle_node;
+    }
+    if (right_tree.min_node != nullptr){
+        right_tree.min_node->prev = middle_node;
+        max_node = right_tree.max_node;
+    }
+    else {
+        max_node = middle_node;
+    }
 
-    delete[] array1;
-    delete[] array2;
-    delete[] merged_array;
+    this->root = joinNodes(root, middle_node, right_tree.root);
+    this->size += 1 + right_tree.size;
+    right_tree.root = nullptr;
+    right_tree.min_node = nullptr;
+    right_tree.max_node = nullptr;
+    right_tree.size = 0;
+    return MY_SUCCESS;
 }
 
+// moves all the data bigger than key to right_tree (which must be empty), and keeps the rest. O(log n).
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::fullTreeRankUpdate() {
-    RankTreeIterator<data_t, rank_t> iter = begin();
-    recursiveRankUpdate(&iter);
+void RankTree<data_t, rank_t>::split(const data_t& key, RankTree<data_t, rank_t>& right_tree){
+    RankTreeNode<data_t, rank_t>* left = nullptr;
+    RankTreeNode<data_t, rank_t>* right = nullptr;
+    RankTreeNode<data_t, rank_t>* key_node = splitNodes(root, key.getTreeKey(), &left, &right);
+
+    // the node of key itself stays in this tree
+    if (key_node != nullptr){
+        left = joinNodes(left, key_node, nullptr);
+    }
+
+    // cut the threads between the max of left and the min of right
+    if (right != nullptr){
+        RankTreeNode<data_t, rank_t>* right_min = right;
+        while (right_min->left != nullptr){
+            right_min = right_min->left;
+        }
+        RankTreeNode<data_t, rank_t>* left_max = right_min->prev;
+        right_min->prev = nullptr;
+        if (left_max != nullptr){
+            left_max->next = nullptr;
+        }
+        else {
+            min_node = nullptr;
+        }
+        right_tree.min_node = right_min;
+        right_tree.max_node = max_node;
+        max_node = left_max;
+    }
+
+    this->root = left;
+    this->size = (left == nullptr) ? 0 : left->rank.getNodeCount();
+    right_tree.root = right;
+    right_tree.size = (right == nullptr) ? 0 : right->rank.getNodeCount();
 }
 
+// moves all the nodes of other_tree to this tree, and leaves other_tree empty. the trees must not share data.
+// the smaller tree is taken apart node by node, and the bigger one is split at each of its nodes, so for trees of
+// sizes m <= n this is O(m*log(n/m + 1)): close to the size of the small tree when it is much smaller.
+// the threads of the bigger tree are kept, and the nodes of the smaller one are linked into them in order, each after
+// its predecessor in the united tree, O(m*log(n + m)).
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::recursiveRankUpdate(RankTreeIterator<data_t, rank_t>* iter) {
-    if (iter->node_ptr == nullptr){
-        return;
+void RankTree<data_t, rank_t>::unionTreeToMe(RankTree<data_t, rank_t>& other_tree){
+    RankTreeNode<data_t, rank_t>* small_list;
+    if (size >= other_tree.size){
+        small_list = other_tree.min_node;
+        this->root = unionNodes(root, other_tree.root);
     }
-
-    if (!iter->checkNullLeft()) {
-        iter->goLeft();
-        recursiveRankUpdate(iter);
-        iter->goFather();
+    else {
+        small_list = min_node;
+        min_node = other_tree.min_node;
+        max_node = other_tree.max_node;
+        this->root = unionNodes(other_tree.root, root);
     }
-
-    if (!iter->checkNullRight()) {
-        iter->goRight();
-        recursiveRankUpdate(iter);
-        iter->goFather();
+    while (small_list != nullptr){
+        RankTreeNode<data_t, rank_t>* next_node = small_list->next;
+        linkAfter(treePredecessor(small_list), small_list);
+        small_list = next_node;
     }
 
-    iter->node_ptr->updateRank();
+    this->size += other_tree.size;
+    other_tree.root = nullptr;
+    other_tree.min_node = nullptr;
+    other_tree.max_node = nullptr;
+    other_tree.size = 0;
 }
 
 template<typename data_t, typename rank_t>
@@ -336,9 +526,11 @@ ReturnValue RankTree<data_t, rank_t>::LLRoll(RankTreeNode<data_t, rank_t>* node)
         root = saved_left_ptr;
     }
 
+    // only me and my previous left son changed sub_trees, the ranks above us stay the same
     node->updateHeight();
     saved_left_ptr->updateHeight();
-    updateRankAlongPath(node);
+    node->updateRank(hist_threshold);
+    saved_left_ptr->updateRank(hist_threshold);
 
     return MY_SUCCESS;
 }
@@ -374,9 +566,11 @@ ReturnValue RankTree<data_t, rank_t>::RRRoll(RankTreeNode<data_t, rank_t>* node)
     if(saved_right_ptr->father == nullptr){
         root = saved_right_ptr;
     }
+    // only me and my previous right son changed sub_trees, the ranks above us stay the same
     node->updateHeight();
     saved_right_ptr->updateHeight();
-   updateRankAlongPath(node);
+    node->updateRank(hist_threshold);
+    saved_right_ptr->updateRank(hist_threshold);
     return MY_SUCCESS;
 }
 
@@ -400,51 +594,43 @@ ReturnValue RankTree<data_t, rank_t>::RLRoll(RankTreeNode<data_t, rank_t>* node)
     return MY_ALLOCATION_ERROR;
 }
 
+// detaches node from the tree without deleting it: the threads of node must be unlinked already, and the ranks must
+// hold its current data.
 template<typename data_t, typename rank_t>
-ReturnValue RankTree<data_t, rank_t>::removeRoot(RankTreeNode<data_t, rank_t>* node) {
+ReturnValue RankTree<data_t, rank_t>::detachRoot(RankTreeNode<data_t, rank_t>* node) {
     if(node->isLeaf()){
         root = nullptr;
-        delete node;
         size--;
         return MY_SUCCESS;
     }
     else if(node->onlyHaveRightSon()) {
         node->right->father = nullptr;
         root = node->right;
-        delete node;
         size--;
         return MY_SUCCESS;
     }
     else if(node->onlyHaveLeftSon()){
         node->left->father = nullptr;
         root = node->left;
-        delete node;
         size--;
         return MY_SUCCESS;
     }
     else{
-        RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node);
-        iter.goRight();
-        while(!iter.checkNullLeft()){
-            iter.goLeft();
-        }
-        swapNodes(node, iter.node_ptr);
-        return removeNonRoot(node);
+        // the in-order successor of a node with 2 sons is the left most node of its right sub_tree
+        swapNodes(node, node->next);
+        return detachNonRoot(node);
     }
 
 }
 
 template<typename data_t, typename rank_t>
-ReturnValue RankTree<data_t, rank_t>::removeNonRoot(RankTreeNode<data_t, rank_t>* node) {
+ReturnValue RankTree<data_t, rank_t>::detachNonRoot(RankTreeNode<data_t, rank_t>* node) {
     if(node->haveTwoSons()){
-        RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node);
-        iter.goRight();
-        while(!iter.checkNullLeft()){
-            iter.goLeft();
-        }
-        swapNodes(node, iter.node_ptr);
+        swapNodes(node, node->next);
     }
 
+    // every node above the removed node loses exactly the removed data
+    data_t removed_data = *node->data;
     RankTreeNode<data_t, rank_t>* future_father;
     if(node->isLeaf()){
         if(node->isALeftSon()){
@@ -454,9 +640,8 @@ ReturnValue RankTree<data_t, rank_t>::removeNonRoot(RankTreeNode<data_t, rank_t>
             node->father->right = nullptr;
         }
         future_father = node->father;
-        delete node;
         size--;
-        RankTree<data_t, rank_t>::updateRankAlongPath(future_father);
+        RankTree<data_t, rank_t>::removeFromRankAlongPath(future_father, removed_data);
         return fixTree(future_father);
     }
     if(node->onlyHaveLeftSon()){
@@ -464,17 +649,15 @@ ReturnValue RankTree<data_t, rank_t>::removeNonRoot(RankTreeNode<data_t, rank_t>
             node->father->left = node->left;
             node->left->father = node->father;
             future_father = node->father;
-            delete node;
             size--;
-            RankTree<data_t, rank_t>::updateRankAlongPath(future_father);
+            RankTree<data_t, rank_t>::removeFromRankAlongPath(future_father, removed_data);
             return fixTree(future_father);
         } else if(node->isARightSon()){
             node->father->right = node->left;
             node->left->father = node->father;
             future_father = node->father;
-            delete node;
             size--;
-            RankTree<data_t, rank_t>::updateRankAlongPath(future_father);
+            RankTree<data_t, rank_t>::removeFromRankAlongPath(future_father, removed_data);
             return fixTree(future_father);
         }
     }
@@ -483,17 +666,15 @@ ReturnValue RankTree<data_t, rank_t>::removeNonRoot(RankTreeNode<data_t, rank_t>
             node->father->left = node->right;
             node->right->father = node->father;
             future_father = node->father;
-            delete node;
             size--;
-            RankTree<data_t, rank_t>::updateRankAlongPath(future_father);
+            RankTree<data_t, rank_t>::removeFromRankAlongPath(future_father, removed_data);
             return fixTree(future_father);
         } else if(node->isARightSon()){
             node->father->right = node->right;
             node->right->father = node->father;
             future_father = node->father;
-            delete node;
             size--;
-            RankTree<data_t, rank_t>::updateRankAlongPath(future_father);
+            RankTree<data_t, rank_t>::removeFromRankAlongPath(future_father, removed_data);
             return fixTree(future_father);
         }
     }
@@ -509,6 +690,18 @@ void RankTree<data_t, rank_t>::swapNodes(RankTreeNode<data_t, rank_t>* node1, Ra
     else{
         swapNonRoot(node1, node2);
     }
+
+    // the rank and height belong to the place, not to the node, so swap them as well.
+    // the place of node1 still holds the same sub_tree. the places between node2's new place and node1's new
+    // place held node2 in their sub_trees, and now hold node1 instead.
+    node1->rank.swap(node2->rank);
+    std::swap(node1->height, node2->height);
+    RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node1);
+    while(iter.node_ptr != node2){
+        iter.node_ptr->rank.removePlayer(*node2->data);
+        iter.node_ptr->rank.addPlayer(*node1->data);
+        iter.goFather();
+    }
 }
 
 template<typename data_t, typename rank_t>
@@ -562,7 +755,6 @@ void RankTree<data_t, rank_t>::swapRoot(RankTreeNode<data_t, rank_t>* received_r
             orig_right_son_of_node->father = node;
         }
     }
-    updateRankAlongPath(received_root);
 }
 
 template<typename data_t, typename rank_t>
@@ -625,211 +817,494 @@ void RankTree<data_t, rank_t>::swapNonRoot(RankTreeNode<data_t, rank_t>* node1,
             orig_right_son_of_node2->father = node1;
         }
     }
-    updateRankAlongPath(node1);
 }
 
+// links the nodes of a tree into a sorted list through their right pointers, by following the threads from its first
+// node, and returns the head of the list
 template<typename data_t, typename rank_t>
-int RankTree<data_t, rank_t>::findRequiredEmptyTreeHeight(int tree_size) {
-    return ceil(log2(tree_size + 1) - 1);
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::threadsToList(RankTreeNode<data_t, rank_t>* first_node){
+    for (RankTreeNode<data_t, rank_t>* node = first_node; node != nullptr; node = node->next){
+        node->right = node->next;
+    }
+    return first_node;
 }
 
+// merges 2 sorted lists (linked through right pointers) into one sorted list, and returns its head
 template<typename data_t, typename rank_t>
-int RankTree<data_t, rank_t>::findNumOfNodesToDelete(int tree_size){
-    int tree_height =findRequiredEmptyTreeHeight(tree_size);
-    double num_of_nodes_to_delete = (exp2(1 + tree_height) - 1) - tree_size;
-    int num_of_nodes_to_delete_int = ceil(num_of_nodes_to_delete);
-    return num_of_nodes_to_delete_int;
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::mergeLists(RankTreeNode<data_t, rank_t>* list1,
+                                                                   RankTreeNode<data_t, rank_t>* list2){
+    RankTreeNode<data_t, rank_t>* merged_list = nullptr;
+    RankTreeNode<data_t, rank_t>** list_end = &merged_list;
+
+    // go over lists 1 and 2, link the node with the smaller data to the merged list
+    while (list1 != nullptr && list2 != nullptr){
+        if (list1->key < list2->key){
+            *list_end = list1;
+            list1 = list1->right;
+        }
+        else {
+            *list_end = list2;
+            list2 = list2->right;
+        }
+        list_end = &(*list_end)->right;
+    }
+
+    // link the rest of the list that wasn't finished
+    *list_end = (list1 != nullptr) ? list1 : list2;
+    return merged_list;
 }
 
+// builds a balanced tree from the first num_of_nodes nodes of the sorted list, and advances *list past them.
+// the sizes of the 2 sub_trees of every node differ by at most 1, so the tree is an AVL tree. the heights and ranks
+// are calculated bottom up, once per node.
 template<typename data_t, typename rank_t>
-RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::createEmptyTree(int* height, int scale){
-    // recursion break point condition
-    if(*height == -1){
-        (*height)++;
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::buildTreeFromList(RankTreeNode<data_t, rank_t>** list,
+                                                                          int num_of_nodes){
+    if (num_of_nodes == 0){
         return nullptr;
     }
 
-    // create new node to add to tree
-    RankTreeNode<data_t, rank_t>* node = new RankTreeNode<data_t, rank_t>(scale);
-    RankTreeNode<data_t, rank_t>* temp_node;
+    int left_size = num_of_nodes / 2;
+    RankTreeNode<data_t, rank_t>* left_son = buildTreeFromList(list, left_size);
 
-    // create left sub_tree with (height-1)
-    *(height) = *(height) - 1;
-    temp_node = createEmptyTree(height, scale);
-    node->left = temp_node;
-    if(temp_node){
-        temp_node->father = node;
+    RankTreeNode<data_t, rank_t>* node = *list;
+    *list = node->right;
+    node->father = nullptr;
+    node->left = left_son;
+    if (left_son != nullptr){
+        left_son->father = node;
     }
 
-    // create right sub_tree with (height-1)
-    *(height) = *(height) - 1;
-    temp_node = createEmptyTree(height, scale);
-    node->right = temp_node;
-    if(temp_node){
-        temp_node->father = node;
+    RankTreeNode<data_t, rank_t>* right_son = buildTreeFromList(list, num_of_nodes - left_size - 1);
+    node->right = right_son;
+    if (right_son != nullptr){
+        right_son->father = node;
     }
 
-    // after creating my sub_trees, update my height
     node->updateHeight();
-    (*height)++;
+    node->updateRank(hist_threshold);
     return node;
 }
 
+// the estimated costs of the merge paths for tree sizes m <= n, in units of the cost of rebuilding one node:
+// - insertion: m*log(n + m) nodes on the insert paths, each getting a delta rank update.
+// - union: about m*log(n/m + 1) nodes relinked by the splits and joins, each getting a full rank update.
+// - rebuild: n + m nodes, each getting a full rank update.
+// a full rank update is much more expensive when it sums score histograms, so the weights depend on whether the
+// ranks hold them.
+// the weights are unitless: the time of one step of a path divided by the time to rebuild one node. they come from
+// `bench_merge 200000` (n = 200000, m from 1000 to 128000): a weight is the path's time / its step count above,
+// divided by the rebuild time / (n + m), from the same row. with score histograms (scale 200) insertion steps
+// measured 0.23 to 0.46 and union steps 1.6 to 2.7. the union weight is above that range, so with histograms the
+// model picks rebuild for m >= 64000, where union measured fastest. without histograms insertion measured 0.3 to 0.5,
+// and union 1.25 to 1.6. re-derive the weights this way after a change to the cost of a rank update.
 template<typename data_t, typename rank_t>
-bool RankTree<data_t, rank_t>::removeExtraTreeNodes(RankTreeNode<data_t, rank_t>* node, int* num_of_nodes_to_delete,
-                                                    int* tree_height){
-    // recursion end condition
-    if (*num_of_nodes_to_delete == 0 || node == nullptr){
-        return false;
+MergePath RankTree<data_t, rank_t>::chooseMergePath(int small_size, int large_size){
+    bool with_hist = (large_size > hist_threshold);
+    double insertion_weight = with_hist ? 0.25 : 0.4;
+    double union_weight = with_hist ? 3.5 : 1.25;
+
+    double insertion_cost = insertion_weight * small_size * log2((double)large_size + small_size);
+    double union_cost = union_weight * small_size * log2((double)large_size / small_size + 1);
+    double rebuild_cost = small_size + large_size;
+
+    if (insertion_cost <= union_cost && insertion_cost <= rebuild_cost){
+        return MERGE_BY_INSERTION;
     }
+    return (union_cost < rebuild_cost) ? MERGE_BY_UNION : MERGE_BY_REBUILD;
+}
 
-    // remove node if it's a leaf and there are still nodes to remove
-    if (node->isLeaf() && *num_of_nodes_to_delete > 0){
-        delete node;
-        (*num_of_nodes_to_delete)--;
-        return true;
+// moves all the nodes of other_tree to this tree, and leaves other_tree empty. the smaller tree is taken apart, and its
+// nodes are inserted one by one to the bigger one. O(m*log(n + m)).
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::insertTreeToMe(RankTree<data_t, rank_t>& other_tree){
+    if (other_tree.size > size){
+        std::swap(root, other_tree.root);
+        std::swap(min_node, other_tree.min_node);
+        std::swap(max_node, other_tree.max_node);
+        std::swap(size, other_tree.size);
     }
 
-    // remove nodes from right sub_tree
-    RankTreeNode<data_t, rank_t>* right_son = node->getRight();
-    if(right_son != nullptr){
-        if (removeExtraTreeNodes(right_son, num_of_nodes_to_delete, tree_height)){
-            node->right = nullptr;
-        }
+    // the nodes are taken in order through the threads, which insertNode then relinks
+    RankTreeNode<data_t, rank_t>* list = other_tree.min_node;
+    other_tree.root = nullptr;
+    other_tree.min_node = nullptr;
+    other_tree.max_node = nullptr;
+    other_tree.size = 0;
+
+    while (list != nullptr){
+        RankTreeNode<data_t, rank_t>* node = list;
+        list = list->next;
+        node->father = nullptr;
+        node->left = nullptr;
+        node->right = nullptr;
+        node->height = 0;
+        insertNode(node);
     }
+}
+
+template<typename data_t, typename rank_t>
+int RankTree<data_t, rank_t>::nodeHeight(RankTreeNode<data_t, rank_t>* node){
+    return (node == nullptr) ? -1 : node->height;
+}
+
+// makes left and right the sons of node, and updates its height and rank. returns node, with no father.
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::linkNode(RankTreeNode<data_t, rank_t>* left,
+                                                                 RankTreeNode<data_t, rank_t>* node,
+                                                                 RankTreeNode<data_t, rank_t>* right){
+    node->father = nullptr;
+    node->left = left;
+    if (left != nullptr){
+        left->father = node;
+    }
+    node->right = right;
+    if (right != nullptr){
+        right->father = node;
+    }
+    node->updateHeight();
+    node->updateRank(hist_threshold);
+    return node;
+}
+
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::rotateLeft(RankTreeNode<data_t, rank_t>* node){
+    RankTreeNode<data_t, rank_t>* right_son = node->right;
+    return linkNode(linkNode(node->left, node, right_son->left), right_son, right_son->right);
+}
 
-    // remove nodes from left sub_tree
-    RankTreeNode<data_t, rank_t>* left_son = node->getLeft();
-    if(left_son != nullptr){
-        if (removeExtraTreeNodes(left_son, num_of_nodes_to_delete, tree_height)){
-            node->left = nullptr;
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::rotateRight(RankTreeNode<data_t, rank_t>* node){
+    RankTreeNode<data_t, rank_t>* left_son = node->left;
+    return linkNode(left_son->left, left_son, linkNode(left_son->right, node, node->right));
+}
+
+// join when left is higher than right by more than 1: middle and right go down the right spine of left, to the first
+// sub_tree that isn't higher than right by more than 1, and the path back up is rebalanced.
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::joinRight(RankTreeNode<data_t, rank_t>* left,
+                                                                  RankTreeNode<data_t, rank_t>* middle,
+                                                                  RankTreeNode<data_t, rank_t>* right){
+    RankTreeNode<data_t, rank_t>* left_son = left->left;
+    RankTreeNode<data_t, rank_t>* right_son = left->right;
+
+    if (nodeHeight(right_son) <= nodeHeight(right) + 1){
+        RankTreeNode<data_t, rank_t>* joined = linkNode(right_son, middle, right);
+        if (nodeHeight(joined) <= nodeHeight(left_son) + 1){
+            return linkNode(left_son, left, joined);
         }
+        return rotateLeft(linkNode(left_son, left, rotateRight(joined)));
     }
 
-    // after removing nodes from both sub_trees, update the height of curr node
-    node->updateHeight();
-    return false;
+    RankTreeNode<data_t, rank_t>* joined = joinRight(right_son, middle, right);
+    RankTreeNode<data_t, rank_t>* new_left = linkNode(left_son, left, joined);
+    if (nodeHeight(joined) <= nodeHeight(left_son) + 1){
+        return new_left;
+    }
+    return rotateLeft(new_left);
 }
 
+// join when right is higher than left by more than 1 (the mirror of joinRight)
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::putTreeToArray(RankTreeNode<data_t, rank_t>* node, RankTreeNode<data_t,
-                                              rank_t>* array[], int* i) {
-    if(node == nullptr){
-        return;
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::joinLeft(RankTreeNode<data_t, rank_t>* left,
+                                                                 RankTreeNode<data_t, rank_t>* middle,
+                                                                 RankTreeNode<data_t, rank_t>* right){
+    RankTreeNode<data_t, rank_t>* left_son = right->left;
+    RankTreeNode<data_t, rank_t>* right_son = right->right;
+
+    if (nodeHeight(left_son) <= nodeHeight(left) + 1){
+        RankTreeNode<data_t, rank_t>* joined = linkNode(left, middle, left_son);
+        if (nodeHeight(joined) <= nodeHeight(right_son) + 1){
+            return linkNode(joined, right, right_son);
+        }
+        return rotateRight(linkNode(rotateLeft(joined), right, right_son));
     }
 
-    putTreeToArray(node->left, array, i);
-    array[*i] = node;
-    (*i)++;
-    putTreeToArray(node->right, array, i);
+    RankTreeNode<data_t, rank_t>* joined = joinLeft(left, middle, left_son);
+    RankTreeNode<data_t, rank_t>* new_right = linkNode(joined, right, right_son);
+    if (nodeHeight(joined) <= nodeHeight(right_son) + 1){
+        return new_right;
+    }
+    return rotateRight(new_right);
 }
 
+// returns a balanced tree of the nodes of left, middle and the nodes of right (in that order)
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::putArrayIntoTree(RankTreeNode<data_t, rank_t>** node, RankTreeNode<data_t,
-                                                rank_t>*** array, int* i){
-    if (!(*node)) {
-        return;
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::joinNodes(RankTreeNode<data_t, rank_t>* left,
+                                                                  RankTreeNode<data_t, rank_t>* middle,
+                                                                  RankTreeNode<data_t, rank_t>* right){
+    if (nodeHeight(left) > nodeHeight(right) + 1){
+        return joinRight(left, middle, right);
+    }
+    if (nodeHeight(right) > nodeHeight(left) + 1){
+        return joinLeft(left, middle, right);
     }
+    return linkNode(left, middle, right);
+}
 
-    if((*node)->left){
-        putArrayIntoTree(&(*node)->left, array, i);
+// splits the sub_tree of node to the nodes smaller than key (*left) and bigger than key (*right). returns the node
+// of key, or nullptr if it isn't in the sub_tree.
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::splitNodes(RankTreeNode<data_t, rank_t>* node,
+                                                                   long long key,
+                                                                   RankTreeNode<data_t, rank_t>** left,
+                                                                   RankTreeNode<data_t, rank_t>** right){
+    if (node == nullptr){
+        *left = nullptr;
+        *right = nullptr;
+        return nullptr;
     }
 
-    (*node)->data = (*(*array)[*i]).getData();
-    (*node)->resetRank();
-    (*i)++;
+    RankTreeNode<data_t, rank_t>* left_son = node->left;
+    RankTreeNode<data_t, rank_t>* right_son = node->right;
+    if (left_son != nullptr){
+        left_son->father = nullptr;
+    }
+    if (right_son != nullptr){
+        right_son->father = nullptr;
+    }
 
-    if ((*node)->right){
-        putArrayIntoTree(&(*node)->right, array, i);
+    RankTreeNode<data_t, rank_t>* key_node;
+    if (key < node->key){
+        RankTreeNode<data_t, rank_t>* left_of_right = nullptr;
+        key_node = splitNodes(left_son, key, left, &left_of_right);
+        *right = joinNodes(left_of_right, node, right_son);
+    }
+    else if (node->key < key){
+        RankTreeNode<data_t, rank_t>* right_of_left = nullptr;
+        key_node = splitNodes(right_son, key, &right_of_left, right);
+        *left = joinNodes(left_son, node, right_of_left);
     }
+    else {
+        *left = left_son;
+        *right = right_son;
+        key_node = node;
+    }
+    return key_node;
 }
 
+// unites the sub_trees of node1 and node2 (which must not share data): node2 is taken apart, node1 is split at it, and
+// the parts are united recursively and joined back at node2.
 template<typename data_t, typename rank_t>
-void RankTree<data_t, rank_t>::mergeArrays(RankTreeNode<data_t, rank_t>* arr1[], RankTreeNode<data_t, rank_t>* arr2[],
-                                           RankTreeNode<data_t, rank_t>* merged_arr[], int arr1_size, int arr2_size) {
-    int i= 0, j = 0, k = 0;
-
-    // go over arrays 1 and 2, insert the element with the smaller data to array3
-    while(i < arr1_size && j < arr2_size){
-        if (*(((RankTreeNode<data_t, rank_t>*)arr1[i])->getData()) < *(((RankTreeNode<data_t, rank_t>*)arr2[j])->getData())){
-            merged_arr[k] = arr1[i];
-            i++;
-        }
-        else {
-            merged_arr[k] = arr2[j];
-            j++;
-        }
-        k++;
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::unionNodes(RankTreeNode<data_t, rank_t>* node1,
+                                                                   RankTreeNode<data_t, rank_t>* node2){
+    if (node1 == nullptr){
+        return node2;
+    }
+    if (node2 == nullptr){
+        return node1;
     }
 
-    // check which of the arrays we finished scanning, add the remaining elements from other array to array3
-    if((arr1_size-i) > (arr2_size-j)){
-        while(k < arr1_size + arr2_size) {
-            merged_arr[k] = arr1[i];
-            i++;
-            k++;
-        }
+    RankTreeNode<data_t, rank_t>* left2 = node2->left;
+    RankTreeNode<data_t, rank_t>* right2 = node2->right;
+    if (left2 != nullptr){
+        left2->father = nullptr;
     }
-    else{
-        while(k < arr1_size + arr2_size) {
-            merged_arr[k] = arr2[j];
-            j++;
-            k++;
-        }
+    if (right2 != nullptr){
+        right2->father = nullptr;
     }
+
+    RankTreeNode<data_t, rank_t>* left1 = nullptr;
+    RankTreeNode<data_t, rank_t>* right1 = nullptr;
+    splitNodes(node1, node2->key, &left1, &right1);
+
+    RankTreeNode<data_t, rank_t>* left = unionNodes(left1, left2);
+    RankTreeNode<data_t, rank_t>* right = unionNodes(right1, right2);
+    return joinNodes(left, node2, right);
 }
 
 template<typename data_t, typename rank_t>
 void RankTree<data_t, rank_t>::updateRankAlongPath(RankTreeNode<data_t, rank_t>* node){
-    node->updateRank();
-    if (node->father != nullptr){
-        updateRankAlongPath(node->father);
+    while (node != nullptr){
+        node->updateRank(hist_threshold);
+        node = node->father;
     }
 }
 
+// a score change doesn't change the tree structure or the node_count/sum_of_levels of any node, so instead of
+// recalculating every rank on the path, only move one count from old_score to new_score in each rank up to the root.
 template<typename data_t, typename rank_t>
-RankTreeNode<data_t, rank_t> *RankTree<data_t, rank_t>::getLeftMostNode() {
-    RankTreeIterator<data_t, rank_t> iter = begin();
-    if(iter.getPtr() == nullptr) {
-        return nullptr;
+void RankTree<data_t, rank_t>::updateScoreAlongPath(RankTreeNode<data_t, rank_t>* node, int old_score, int new_score){
+    RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node);
+    while(iter.node_ptr != nullptr){
+        iter.node_ptr->rank.updateScore(old_score, new_score);
+        iter.goFather();
     }
+}
 
-    if(iter.checkNullLeft()){
-        return iter.node_ptr;
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::addToRankAlongPath(RankTreeNode<data_t, rank_t>* node, data_t data){
+    RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node);
+    while(iter.node_ptr != nullptr){
+        iter.node_ptr->rank.addPlayer(data);
+        if (!iter.node_ptr->rank.hasScoreHist() && iter.node_ptr->rank.getNodeCount() > hist_threshold){
+            // the sub_tree just grew over the threshold, build its score histogram from its nodes
+            iter.node_ptr->rank.createScoreHist(iter.node_ptr->rank.getNodeCount());
+            iter.node_ptr->addSubtreeScoresTo(&iter.node_ptr->rank);
+        }
+        iter.goFather();
     }
-    iter.goLeft();
-    while(iter.node_ptr){
-        if(iter.checkNullLeft()){
-            return iter.node_ptr;
+}
+
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::removeFromRankAlongPath(RankTreeNode<data_t, rank_t>* node, data_t data){
+    RankTreeIterator<data_t, rank_t> iter = RankTreeIterator<data_t, rank_t>(node);
+    while(iter.node_ptr != nullptr){
+        iter.node_ptr->rank.removePlayer(data);
+        if (iter.node_ptr->rank.hasScoreHist() && iter.node_ptr->rank.getNodeCount() <= hist_threshold){
+            iter.node_ptr->rank.dropScoreHist();
         }
-        iter.goLeft();
+        iter.goFather();
     }
+}
 
-    return iter.node_ptr;
+// returns the node with the k-th smallest data in the tree (k starts at 1), or nullptr if there is no such node
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::select(int k){
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node != nullptr){
+        int left_count = (node->left == nullptr) ? 0 : node->left->rank.getNodeCount();
+        if(k == left_count + 1){
+            return node;
+        }
+        if(k <= left_count){
+            node = node->left;
+        }
+        else{
+            k -= left_count + 1;
+            node = node->right;
+        }
+    }
+    return nullptr;
 }
 
+// returns the amount of datas in the tree that are <= key. key doesn't have to be in the tree.
 template<typename data_t, typename rank_t>
-RankTreeNode<data_t, rank_t> *RankTree<data_t, rank_t>::getRightMostNode() {
-    RankTreeIterator<data_t, rank_t> iter = begin();
-    if(iter.node_ptr == nullptr) {
-        return nullptr;
+int RankTree<data_t, rank_t>::rankOf(const data_t& key){
+    int count = 0;
+    long long bound = key.getTreeKey();
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node != nullptr){
+        if(bound < node->key){
+            node = node->left;
+        }
+        else{
+            count += 1 + ((node->left == nullptr) ? 0 : node->left->rank.getNodeCount());
+            node = node->right;
+        }
     }
+    return count;
+}
 
-    if(iter.checkNullRight()){
-        return iter.node_ptr;
+// returns an in-order cursor at the smallest data in the tree that is >= key (at the end if there is none). key
+// doesn't have to be in the tree.
+template<typename data_t, typename rank_t>
+RankTreeIterator<data_t, rank_t> RankTree<data_t, rank_t>::lowerBound(const data_t& key){
+    RankTreeNode<data_t, rank_t>* bound = nullptr;
+    long long search_key = key.getTreeKey();
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node != nullptr){
+        if(node->key < search_key){
+            node = node->right;
+        }
+        else{
+            bound = node;
+            node = node->left;
+        }
     }
-    iter.goRight();
-    while(iter.node_ptr){
-        if(iter.checkNullRight()){
-            return iter.node_ptr;
+    return RankTreeIterator<data_t, rank_t>(bound);
+}
+
+// adds the ranks of all the datas in the tree that are <= key to total: the node itself and its left sub_tree, for
+// every node on the path where the walk turns right.
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::prefixAggregate(const data_t& key, rank_t* total){
+    long long bound = key.getTreeKey();
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node != nullptr){
+        if(bound < node->key){
+            node = node->left;
+        }
+        else{
+            if(node->left != nullptr){
+                node->left->addSubtreeRankTo(total);
+            }
+            total->addPlayer(*node->data);
+            node = node->right;
         }
-        iter.goRight();
     }
+}
 
-    return iter.node_ptr;
+// adds the ranks of the k smallest datas in the tree to total
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::prefixAggregateByCount(int k, rank_t* total){
+    RankTreeNode<data_t, rank_t>* node = root;
+    while(node != nullptr && k > 0){
+        int left_count = (node->left == nullptr) ? 0 : node->left->rank.getNodeCount();
+        if(k <= left_count){
+            node = node->left;
+        }
+        else{
+            if(node->left != nullptr){
+                node->left->addSubtreeRankTo(total);
+            }
+            total->addPlayer(*node->data);
+            k -= left_count + 1;
+            node = node->right;
+        }
+    }
 }
 
+// links node (which isn't threaded) into the threads right after prev_node, or first if prev_node is nullptr
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::linkAfter(RankTreeNode<data_t, rank_t>* prev_node, RankTreeNode<data_t, rank_t>* node){
+    node->prev = prev_node;
+    node->next = (prev_node == nullptr) ? min_node : prev_node->next;
+    if (prev_node == nullptr){
+        min_node = node;
+    }
+    else {
+        prev_node->next = node;
+    }
+    if (node->next == nullptr){
+        max_node = node;
+    }
+    else {
+        node->next->prev = node;
+    }
+}
 
+// links the neighbours of node to each other. node itself still points to them, until it is deleted.
+template<typename data_t, typename rank_t>
+void RankTree<data_t, rank_t>::unlinkNode(RankTreeNode<data_t, rank_t>* node){
+    if (node->prev == nullptr){
+        min_node = node->next;
+    }
+    else {
+        node->prev->next = node->next;
+    }
+    if (node->next == nullptr){
+        max_node = node->prev;
+    }
+    else {
+        node->next->prev = node->prev;
+    }
+}
 
+// returns the in-order predecessor of node by the tree structure (not the threads), or nullptr if node is the minimum
+template<typename data_t, typename rank_t>
+RankTreeNode<data_t, rank_t>* RankTree<data_t, rank_t>::treePredecessor(RankTreeNode<data_t, rank_t>* node){
+    if (node->left != nullptr){
+        node = node->left;
+        while (node->right != nullptr){
+            node = node->right;
+        }
+        return node;
+    }
+    while (node->father != nullptr && node->father->left == node){
+        node = node->father;
+    }
+    return node->father;
+}
 
 #endif //WET2_RANK_TREE_H
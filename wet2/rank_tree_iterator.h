@@ -16,6 +16,15 @@ public:
     void goFather() { node_ptr = node_ptr->father; }
     void goLeft() { node_ptr = node_ptr->left; }
     void goRight() { node_ptr = node_ptr->right; }
+    void goPrev() { node_ptr = node_ptr->prev; }
+    void goNext() { node_ptr = node_ptr->next; }
+
+    // in-order cursor: steps over the datas of the tree in order through the threads of the nodes, O(1) per step.
+    // the cursor is at the end once it steps past the first or the last data.
+    bool isEnd() const { return node_ptr == nullptr; }
+    RankTreeIterator& operator++() { goNext(); return *this; }
+    RankTreeIterator& operator--() { goPrev(); return *this; }
+    data_t& operator*() const { return *node_ptr->data; }
     bool checkNullFather() { return (node_ptr->father == nullptr); }
     bool checkNullLeft() { return (node_ptr->left == nullptr); }
     bool checkNullRight() { return (node_ptr->right == nullptr); }
@@ -5,27 +5,42 @@
 
 using std::max;
 
+// an upper bound of the height of an AVL tree (a tree of height h has more than 1.6^h nodes), for the explicit stacks
+// of the non-recursive walks
+#define RANK_TREE_MAX_HEIGHT 64
+
 template<typename data_t, typename rank_t> class RankTree;
 template<typename data_t, typename rank_t> class RankTreeIterator;
 
 template<typename data_t, typename rank_t>
 class RankTreeNode {
     data_t* data;
+    // the packed key of data (data_t::getTreeKey) as it was when the node was inserted, which the tree compares instead
+    // of data: one integer compare, and no access to data during a descent
+    long long key;
     rank_t rank;
     int height;
     RankTreeNode* father;
     RankTreeNode* left;
     RankTreeNode* right;
+    // the in-order neighbours of the node in its tree (nullptr at the ends of the tree)
+    RankTreeNode* prev;
+    RankTreeNode* next;
     
 public:
-    explicit RankTreeNode(int scale): data(new data_t()), father(nullptr), left(nullptr), right(nullptr), height(0), rank(rank_t(scale)) {}
-    explicit RankTreeNode(data_t* data, int scale): data(data), father(nullptr), left(nullptr), right(nullptr), height(0), rank(rank_t(scale)) {}
+    explicit RankTreeNode(int scale): data(new data_t()), key(data->getTreeKey()), father(nullptr), left(nullptr), right(nullptr), height(0), rank(rank_t(scale)),
+                                      prev(nullptr), next(nullptr) {}
+    explicit RankTreeNode(data_t* data, int scale): data(data), key(data->getTreeKey()), father(nullptr), left(nullptr), right(nullptr), height(0), rank(rank_t(scale)),
+                                                    prev(nullptr), next(nullptr) {}
     ~RankTreeNode();
     RankTreeNode* getFather() { return father; }
     RankTreeNode* getLeft() { return left; }
     RankTreeNode* getRight() { return right; }
+    RankTreeNode* getPrev() { return prev; }
+    RankTreeNode* getNext() { return next; }
     data_t* getData() { return data; }
-    rank_t getRank() { return rank; }
+    long long getKey() const { return key; }
+    const rank_t& getRank() const { return rank; }
     bool isLeaf(); 
     bool onlyHaveLeftSon();  
     bool onlyHaveRightSon();  
@@ -33,11 +48,16 @@ public:
     bool isALeftSon();  
     bool isARightSon();
     void updateHeight();
-    void updateRank();
+    void updateRank(int hist_threshold);
     void resetRank();
     int getBF();
+    void addSubtreeRankTo(rank_t* total) const;
+    void removeSubtreeRankFrom(rank_t* total) const;
+    void addSubtreeScoresTo(rank_t* total) const;
+    void removeSubtreeScoresFrom(rank_t* total) const;
 
-    static void recursiveNodeDeletion(RankTreeNode<data_t, rank_t>* node);
+    template<typename visit_t> void forEachInSubtree(visit_t visit) const;
+    static void deleteSubtree(RankTreeNode<data_t, rank_t>* node);
     friend class RankTree<data_t, rank_t>;
     friend class RankTreeIterator<data_t, rank_t>;
 };
@@ -47,6 +67,8 @@ RankTreeNode<data_t, rank_t>::~RankTreeNode(){
     father = nullptr;
     left = nullptr;
     right = nullptr;
+    prev = nullptr;
+    next = nullptr;
     data = nullptr;
 }
 
@@ -118,24 +140,33 @@ void RankTreeNode<data_t, rank_t>::updateHeight() {
     height = 1 + max(left_height, right_height);
 }
 
+// only ranks of sub_trees with more than hist_threshold nodes hold a score histogram
 template<typename data_t, typename rank_t>
-void RankTreeNode<data_t, rank_t>::updateRank() {
-    resetRank();
-    if (isLeaf()){
+void RankTreeNode<data_t, rank_t>::updateRank(int hist_threshold) {
+    int sub_tree_size = 1;
+    sub_tree_size += (left == nullptr) ? 0 : left->rank.getNodeCount();
+    sub_tree_size += (right == nullptr) ? 0 : right->rank.getNodeCount();
+    bool with_hist = (sub_tree_size > hist_threshold);
+
+    // common case: build the rank from both sons in one pass (no clearing, and one fused histogram sum)
+    if (haveTwoSons() && (!with_hist || (left->rank.hasScoreHist() && right->rank.hasScoreHist()))){
+        rank.initializeRank(*data, left->rank, right->rank, with_hist);
         return;
     }
-    if(onlyHaveLeftSon()){
-        rank += left->rank;
-        return;
+
+    if (with_hist){
+        rank.createScoreHist(sub_tree_size);
     }
-    if(onlyHaveRightSon()){
-        rank += right->rank;
-        return;
+    else {
+        rank.dropScoreHist();
     }
-    if(haveTwoSons()){
-        rank += left->rank;
-        rank += right->rank;
-        return;
+
+    resetRank();
+    if (left != nullptr){
+        left->addSubtreeRankTo(&rank);
+    }
+    if (right != nullptr){
+        right->addSubtreeRankTo(&rank);
     }
 }
 
@@ -145,6 +176,61 @@ void RankTreeNode<data_t, rank_t>::resetRank() {
 }
 
 
+// adds the rank of this node's sub_tree to total. if the sub_tree is too small to hold a score histogram, and total
+// does hold one, the scores of the sub_tree are added one by one.
+template<typename data_t, typename rank_t>
+void RankTreeNode<data_t, rank_t>::addSubtreeRankTo(rank_t* total) const {
+    *total += rank;
+    if (total->hasScoreHist() && !rank.hasScoreHist()){
+        addSubtreeScoresTo(total);
+    }
+}
+
+template<typename data_t, typename rank_t>
+void RankTreeNode<data_t, rank_t>::removeSubtreeRankFrom(rank_t* total) const {
+    *total -= rank;
+    if (total->hasScoreHist() && !rank.hasScoreHist()){
+        removeSubtreeScoresFrom(total);
+    }
+}
+
+// calls visit on the data of every node in the sub_tree of this node (in pre-order), with an explicit stack instead of
+// recursion
+template<typename data_t, typename rank_t>
+template<typename visit_t>
+void RankTreeNode<data_t, rank_t>::forEachInSubtree(visit_t visit) const {
+    const RankTreeNode* stack[RANK_TREE_MAX_HEIGHT];
+    int stack_size = 0;
+    const RankTreeNode* node = this;
+    while (node != nullptr){
+        visit(*node->data);
+        if (node->left != nullptr){
+            // the right son waits for the left sub_tree. at most one son per level is waiting, so the stack is
+            // never deeper than the tree.
+            if (node->right != nullptr){
+                stack[stack_size++] = node->right;
+            }
+            node = node->left;
+        }
+        else if (node->right != nullptr){
+            node = node->right;
+        }
+        else {
+            node = (stack_size == 0) ? nullptr : stack[--stack_size];
+        }
+    }
+}
+
+template<typename data_t, typename rank_t>
+void RankTreeNode<data_t, rank_t>::addSubtreeScoresTo(rank_t* total) const {
+    forEachInSubtree([total](const data_t& data) { total->addPlayerScore(data); });
+}
+
+template<typename data_t, typename rank_t>
+void RankTreeNode<data_t, rank_t>::removeSubtreeScoresFrom(rank_t* total) const {
+    forEachInSubtree([total](const data_t& data) { total->removePlayerScore(data); });
+}
+
 template<typename data_t, typename rank_t>
 int RankTreeNode<data_t, rank_t>::getBF() {
     int left_height = (left == nullptr) ? -1 : left->height;
@@ -152,22 +238,32 @@ int RankTreeNode<data_t, rank_t>::getBF() {
     return (left_height - right_height);
 }
 
+// deletes all the nodes of the sub_tree of node, in O(1) space: while the current node has a left son, the tree is
+// rotated right at it, and once it has none the node is deleted and its right sub_tree is next.
 template<typename data_t, typename rank_t>
-void RankTreeNode<data_t, rank_t>::recursiveNodeDeletion(RankTreeNode<data_t, rank_t>* node) {
+void RankTreeNode<data_t, rank_t>::deleteSubtree(RankTreeNode<data_t, rank_t>* node) {
     if (node == nullptr) {
         return;
     }
-    recursiveNodeDeletion(node->left);
-    recursiveNodeDeletion(node->right);
-
     if (node->isALeftSon()) {
         node->father->left = nullptr;
     }
-    else {
-        if (node->isARightSon()) {
-            node->father->right = nullptr;
+    else if (node->isARightSon()) {
+        node->father->right = nullptr;
+    }
+
+    while (node != nullptr) {
+        RankTreeNode<data_t, rank_t>* left_son = node->left;
+        if (left_son != nullptr) {
+            node->left = left_son->right;
+            left_son->right = node;
+            node = left_son;
+        }
+        else {
+            RankTreeNode<data_t, rank_t>* right_son = node->right;
+            delete node;
+            node = right_son;
         }
     }
-    delete node;
 }
 #endif //WET2_RANK_TREE_NODE_H
@@ -1,16 +1,39 @@
 rm a.out;
-for i in {0..14};
+rm query_allocations;
+rm snapshot_consistency;
+rm frozen_queries;
+rm skiplist_concurrency;
+for i in {0..15};
 do rm ../tests_out/my_out$i.txt;
 done
 
 g++ -std=c++11 -DNDEBUG -Wall *.cpp
+g++ -std=c++11 -DNDEBUG -Wall ../tests/query_allocations.cpp $(ls *.cpp | grep -v main2.cpp) -o query_allocations
+g++ -std=c++11 -DNDEBUG -Wall ../tests/snapshot_consistency.cpp $(ls *.cpp | grep -v main2.cpp) -o snapshot_consistency
+g++ -std=c++11 -DNDEBUG -Wall ../tests/frozen_queries.cpp $(ls *.cpp | grep -v main2.cpp) -o frozen_queries
+g++ -std=c++11 -DNDEBUG -Wall -pthread ../tests/skiplist_concurrency.cpp $(ls *.cpp | grep -v main2.cpp) -o skiplist_concurrency
 echo compiled
 
-for i in {0..14};
+for i in {0..15};
 do ./a.out < ../tests/in$i.txt > ../tests_out/my_out$i.txt;
 done
 
 
-for i in {0..14};
+for i in {0..15};
 do diff -s ../tests/out$i.txt  ../tests_out/my_out$i.txt;
-done
\ No newline at end of file
+done
+
+# conformance of the group indexes: the same tests, with the groups keeping their players in every GroupIndex
+for index in avl b+tree levels skiplist;
+do for i in {0..15};
+do ./a.out $index < ../tests/in$i.txt | diff -q ../tests/out$i.txt - > /dev/null || echo "$index: test $i differs";
+done;
+done
+
+./query_allocations
+
+./snapshot_consistency
+
+./frozen_queries
+
+./skiplist_concurrency
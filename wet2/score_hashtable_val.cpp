@@ -0,0 +1,27 @@
+#include "score_hashtable_val.h"
+
+
+ScoreHashTableVal::~ScoreHashTableVal() {
+    score_tree = nullptr;
+}
+
+bool ScoreHashTableVal::operator==(ScoreHashTableVal* other_val) {
+    if (other_val == nullptr) {
+        return false;
+    }
+    return (score == other_val->score);
+}
+
+ScoreHashTableVal& ScoreHashTableVal::operator=(ScoreHashTableVal* other_val) {
+    if (other_val == nullptr) {
+        score = 0;
+        level_0_count = 0;
+        score_tree = nullptr;
+    }
+    else {
+        score = other_val->score;
+        level_0_count = other_val->level_0_count;
+        score_tree = other_val->score_tree;
+    }
+    return *this;
+}
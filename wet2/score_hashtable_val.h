@@ -0,0 +1,32 @@
+#ifndef WET2_SCORE_HASHTABLE_VAL_H
+#define WET2_SCORE_HASHTABLE_VAL_H
+
+#include "player.h"
+#include "count_rank.h"
+#include "rank_tree.h"
+
+// the players of one score in a ScoreIndex: the amount of level 0 players, and a tree of the players with level > 0.
+// vals are copied around by the hash table, so the tree is owned (and deleted) by the ScoreIndex.
+class ScoreHashTableVal {
+    int score;
+    int level_0_count;
+    RankTree<Player, CountRank>* score_tree;
+
+public:
+    explicit ScoreHashTableVal(int score) : score(score), level_0_count(0), score_tree(nullptr) {}
+    ScoreHashTableVal() : score(0), level_0_count(0), score_tree(nullptr) {}
+    ~ScoreHashTableVal();
+    int getKey() { return score; }
+    int getScore() { return score; }
+    int getLevel0Count() { return level_0_count; }
+    void addToLevel0Count(int amount) { level_0_count += amount; }
+    RankTree<Player, CountRank>* getScoreTree() { return score_tree; }
+    void setScoreTree(RankTree<Player, CountRank>* new_score_tree) { score_tree = new_score_tree; }
+    bool isEmpty() { return level_0_count == 0 && score_tree->getSize() == 0; }
+
+    bool operator==(ScoreHashTableVal* other_val);
+    ScoreHashTableVal& operator=(ScoreHashTableVal* other_val);
+};
+
+
+#endif //WET2_SCORE_HASHTABLE_VAL_H
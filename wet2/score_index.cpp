@@ -0,0 +1,167 @@
+#include "score_index.h"
+#include <climits>
+
+ScoreIndex::ScoreIndex(int scale) : scale(scale) {
+    scores_hash_table = new DynamicHashTable<ScoreHashTableVal>();
+    if (!scores_hash_table){
+        throw std::bad_alloc();
+    }
+}
+
+ScoreIndex::~ScoreIndex() {
+    deleteScoreTrees();
+    delete scores_hash_table;
+}
+
+void ScoreIndex::deleteScoreTrees() {
+    for (int i = 0; i < scores_hash_table->getMaxSize(); i++){
+        ScoreHashTableVal* score_val = scores_hash_table->getDataPtrAt(i);
+        if (score_val != nullptr){
+            delete score_val->getScoreTree();
+        }
+    }
+}
+
+// removes all players from the index
+void ScoreIndex::clearIndex() {
+    deleteScoreTrees();
+    scores_hash_table->clearTable();
+}
+
+ScoreHashTableVal* ScoreIndex::getScoreVal(int score) {
+    // no player has a score out of the scale (and a negative score would hash out of the table)
+    if (score < 1 || score > scale){
+        return nullptr;
+    }
+    ScoreHashTableVal dummy_val = ScoreHashTableVal(score);
+    return scores_hash_table->getDataPtr(dummy_val);
+}
+
+// returns the val of score, and creates an empty one if no player in the index has that score
+ScoreHashTableVal* ScoreIndex::getOrCreateScoreVal(int score) {
+    ScoreHashTableVal* score_val = getScoreVal(score);
+    if (score_val != nullptr){
+        return score_val;
+    }
+
+    // the score trees hold no score histograms, only node counts
+    ScoreHashTableVal new_val = ScoreHashTableVal(score);
+    new_val.setScoreTree(new RankTree<Player, CountRank>(INT_MAX));
+    if (scores_hash_table->insertData(new_val) != MY_SUCCESS){
+        delete new_val.getScoreTree();
+        return nullptr;
+    }
+
+    // the insertion may have rescaled the hash table, so find the val again
+    return getScoreVal(score);
+}
+
+// scores with no players are removed, so the index only holds scores that players have
+void ScoreIndex::removeScoreValIfEmpty(ScoreHashTableVal* score_val) {
+    if (!score_val->isEmpty()){
+        return;
+    }
+    ScoreHashTableVal empty_val = *score_val;
+    delete empty_val.getScoreTree();
+    scores_hash_table->removeData(empty_val);
+}
+
+ReturnValue ScoreIndex::addPlayer(Player* player) {
+    if (player == nullptr){
+        return MY_INVALID_INPUT;
+    }
+
+    ScoreHashTableVal* score_val = getOrCreateScoreVal(player->getScore());
+    if (score_val == nullptr){
+        return MY_ALLOCATION_ERROR;
+    }
+
+    if (player->getLevel() == 0){
+        score_val->addToLevel0Count(1);
+        return MY_SUCCESS;
+    }
+    return score_val->getScoreTree()->insert(player, scale);
+}
+
+// the player is found by its current score and level
+ReturnValue ScoreIndex::removePlayer(Player player) {
+    ScoreHashTableVal* score_val = getScoreVal(player.getScore());
+    if (score_val == nullptr){
+        return ELEMENT_DOES_NOT_EXIST;
+    }
+
+    if (player.getLevel() == 0){
+        if (score_val->getLevel0Count() == 0){
+            return ELEMENT_DOES_NOT_EXIST;
+        }
+        score_val->addToLevel0Count(-1);
+    }
+    else {
+        ReturnValue res = score_val->getScoreTree()->remove(player);
+        if (res != MY_SUCCESS){
+            return res;
+        }
+    }
+
+    removeScoreValIfEmpty(score_val);
+    return MY_SUCCESS;
+}
+
+// player already holds its new score. moves it from the players of old_score to the players of its new score.
+ReturnValue ScoreIndex::updatePlayerScore(Player* player, int old_score) {
+    if (player == nullptr){
+        return MY_INVALID_INPUT;
+    }
+
+    Player old_player = *player;
+    old_player.setScore(old_score);
+    ReturnValue res = removePlayer(old_player);
+    if (res != MY_SUCCESS){
+        return res;
+    }
+    return addPlayer(player);
+}
+
+// the amount of players with the given score, and level between lower_level and higher_level (inclusive)
+int ScoreIndex::countPlayersWithScore(int score, int lower_level, int higher_level) {
+    ScoreHashTableVal* score_val = getScoreVal(score);
+    if (score_val == nullptr || higher_level < lower_level){
+        return 0;
+    }
+
+    int count = 0;
+    if (lower_level <= 0 && higher_level >= 0){
+        count += score_val->getLevel0Count();
+    }
+    if (higher_level > 0){
+        count += score_val->getScoreTree()->rankOf(Player::levelUpperBound(higher_level));
+        if (lower_level > 1){
+            count -= score_val->getScoreTree()->rankOf(Player::levelUpperBound(lower_level - 1));
+        }
+    }
+    return count;
+}
+
+// moves all the players of other_index to this index, and leaves other_index empty.
+// scores that only other_index has move with their trees as they are. the trees of scores that both indexes have
+// are merged, in time linear in the size of both trees.
+void ScoreIndex::mergeIndexToMe(ScoreIndex& other_index) {
+    for (int i = 0; i < other_index.scores_hash_table->getMaxSize(); i++){
+        ScoreHashTableVal* other_val = other_index.scores_hash_table->getDataPtrAt(i);
+        if (other_val == nullptr){
+            continue;
+        }
+
+        ScoreHashTableVal* score_val = getScoreVal(other_val->getScore());
+        if (score_val == nullptr){
+            scores_hash_table->insertData(*other_val);
+            continue;
+        }
+        score_val->addToLevel0Count(other_val->getLevel0Count());
+        score_val->getScoreTree()->mergeTreeToMe(*other_val->getScoreTree());
+        delete other_val->getScoreTree();
+    }
+
+    // the trees of other_index were moved or deleted above
+    other_index.scores_hash_table->clearTable();
+}
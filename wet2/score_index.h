@@ -0,0 +1,35 @@
+#ifndef WET2_SCORE_INDEX_H
+#define WET2_SCORE_INDEX_H
+
+#include "dynamic_hash_table.h"
+#include "score_hashtable_val.h"
+
+// the players of a group, indexed by score: for every score that some player in the group has, the amount of level 0
+// players with that score, and a tree (ordered by level) of the players with level > 0 and that score.
+// counting the players with a score in a level range is O(log n), and the memory depends only on the amount of
+// players, not on the scale. used instead of score histograms for large scales (see MAX_HIST_SCALE in group.h).
+class ScoreIndex {
+    int scale;
+    DynamicHashTable<ScoreHashTableVal>* scores_hash_table;
+
+    ScoreHashTableVal* getScoreVal(int score);
+    ScoreHashTableVal* getOrCreateScoreVal(int score);
+    void removeScoreValIfEmpty(ScoreHashTableVal* score_val);
+    void deleteScoreTrees();
+
+public:
+    explicit ScoreIndex(int scale);
+    ~ScoreIndex();
+    ScoreIndex(const ScoreIndex& other_index) = delete;
+    ScoreIndex& operator=(const ScoreIndex& other_index) = delete;
+
+    void clearIndex();
+    ReturnValue addPlayer(Player* player);
+    ReturnValue removePlayer(Player player);
+    ReturnValue updatePlayerScore(Player* player, int old_score);
+    int countPlayersWithScore(int score, int lower_level, int higher_level);
+    void mergeIndexToMe(ScoreIndex& other_index);
+};
+
+
+#endif //WET2_SCORE_INDEX_H
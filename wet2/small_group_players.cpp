@@ -0,0 +1,73 @@
+#include "small_group_players.h"
+#include <cstring>
+
+// frees the array, so an emptied group holds no memory
+void SmallGroupPlayers::clear() {
+    delete[] players;
+    players = nullptr;
+    size = 0;
+}
+
+int SmallGroupPlayers::find(int player_id) const {
+    for (int i = 0; i < size; i++) {
+        if (players[i].id == player_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SmallGroupPlayers::addPlayer(Player* player) {
+    if (!players) {
+        players = new SmallPlayer[max_size];
+        if (!players) throw std::bad_alloc();
+    }
+
+    int level = player->getLevel(), id = player->getPlayerID();
+    int index = size;
+    while (index > 0 && !isBefore(players[index - 1], level, id)) {
+        players[index] = players[index - 1];
+        index--;
+    }
+    players[index].level = level;
+    players[index].id = id;
+    players[index].score = player->getScore();
+    players[index].player = player;
+    size++;
+}
+
+void SmallGroupPlayers::removePlayer(int index) {
+    memmove(players + index, players + index + 1, (size - index - 1) * sizeof(SmallPlayer));
+    size--;
+}
+
+// the level only grows, so the player moves towards the end of the array
+void SmallGroupPlayers::updatePlayerLevel(int index) {
+    SmallPlayer moved = players[index];
+    moved.level = moved.player->getLevel();
+    while (index + 1 < size && isBefore(players[index + 1], moved.level, moved.id)) {
+        players[index] = players[index + 1];
+        index++;
+    }
+    players[index] = moved;
+}
+
+void SmallGroupPlayers::countInLevelRange(int lower_level, int higher_level, int score, int* players_count,
+                                          int* players_with_score) const {
+    *players_count = 0;
+    *players_with_score = 0;
+    for (int i = 0; i < size; i++) {
+        if (players[i].level >= lower_level && players[i].level <= higher_level) {
+            (*players_count)++;
+            *players_with_score += (players[i].score == score);
+        }
+    }
+}
+
+long SmallGroupPlayers::sumOfHighestLevels(int m) const {
+    long level_sum = 0;
+    for (int i = size - m; i < size; i++) {
+        level_sum += players[i].level;
+    }
+    return level_sum;
+}
@@ -0,0 +1,54 @@
+#ifndef WET2_SMALL_GROUP_PLAYERS_H
+#define WET2_SMALL_GROUP_PLAYERS_H
+
+#include "player.h"
+#include "rank_tree.h"
+
+// the players of a small group (see SMALL_GROUP_MAX_SIZE in group.h): one array of (level, id, score) sorted by
+// (level, id), instead of the hash table, list, histograms and index of a bigger group. the queries scan it. the
+// array of max_size players is allocated once, when the first player is added, and freed when the group is emptied
+// or promoted, so an empty group allocates nothing.
+class SmallGroupPlayers {
+    struct SmallPlayer {
+        int level;
+        int id;
+        int score;
+        Player* player;
+    };
+
+    SmallPlayer* players;
+    int size;
+    int max_size;
+
+    static bool isBefore(const SmallPlayer& small_player, int level, int id) {
+        return small_player.level < level || (small_player.level == level && small_player.id < id);
+    }
+
+public:
+    // a max_size of 0 still holds one player, though a group with SMALL_GROUP_MAX_SIZE 0 never adds one
+    explicit SmallGroupPlayers(int max_size) : players(nullptr), size(0), max_size(max_size > 0 ? max_size : 1) {}
+    ~SmallGroupPlayers() { delete[] players; }
+    SmallGroupPlayers(const SmallGroupPlayers& other_players) = delete;
+    SmallGroupPlayers& operator=(const SmallGroupPlayers& other_players) = delete;
+
+    int getSize() const { return size; }
+    Player* getPlayer(int index) const { return players[index].player; }
+    int getLevel(int index) const { return players[index].level; }
+    Player* getLowestPlayer() const { return size ? players[0].player : nullptr; }
+    Player* getHighestPlayer() const { return size ? players[size - 1].player : nullptr; }
+    void clear();
+    // the index of the player, or -1 if it isn't in the group
+    int find(int player_id) const;
+    // the group must hold less than max_size players
+    void addPlayer(Player* player);
+    void removePlayer(int index);
+    // moves the player at index to its place, after its level was increased
+    void updatePlayerLevel(int index);
+    void updatePlayerScore(int index, int new_score) { players[index].score = new_score; }
+    // counts the players with level in [lower_level, higher_level], and how many of them have the given score
+    void countInLevelRange(int lower_level, int higher_level, int score, int* players_count,
+                           int* players_with_score) const;
+    long sumOfHighestLevels(int m) const;
+};
+
+#endif //WET2_SMALL_GROUP_PLAYERS_H
@@ -1,6 +1,7 @@
 #include "system_manager.h"
 
-SystemManager::SystemManager(int groups_num, int scale) {
+SystemManager::SystemManager(int groups_num, int scale, int hist_threshold, GroupTreeType tree_type,
+                             bool with_snapshots) {
     // update all params with given values
     num_of_groups = groups_num+1;
     this->scale = scale;
@@ -17,7 +18,7 @@ SystemManager::SystemManager(int groups_num, int scale) {
     // for each group, create new Group object and insert it to the up_tree node in union array
     ReturnValue res;
     for (int i = 0; i < num_of_groups; i++){
-        Group* new_group = new Group(i, scale);
+        Group* new_group = new Group(i, scale, hist_threshold, tree_type, with_snapshots);
         if (!new_group){
             throw std::bad_alloc();
         }
@@ -168,18 +169,20 @@ ReturnValue SystemManager::increasePlayerLevel(int playerID, int level_increase)
         return MY_FAILURE;
     }
 
-    // remove player with playerID from "all_players_group" (group 0) and from group with groupID
-    // removePlayer function will check if player is in game, and if so it will remove it from both groups
-    res = removePlayer(playerID);
+    Group* group;
+    res = getGroupPtr(temp_player->getGroupID(), &group);
     if (res != MY_SUCCESS){
         return res;
     }
 
-    // increase player level (of real player ptr)
+    // increase player level (of real player ptr), then move the player to its new level in both groups.
+    // the groups keep the player's hash_table val and tree node, so the player isn't removed and added again.
     temp_player->increaseLevel(level_increase);
-
-    // insert player with increased level to both groups
-    return addExistingPlayer(temp_player);
+    res = all_players_group->increasePlayerLevel(temp_player, level_increase);
+    if (res != MY_SUCCESS){
+        return res;
+    }
+    return group->increasePlayerLevel(temp_player, level_increase);
 }
 
 ReturnValue SystemManager::updatePlayerScore(int playerID, int new_score){
@@ -277,7 +280,26 @@ ReturnValue SystemManager::getPlayersBoundByGroup(int groupID, int m, int score,
     return res;
 }
 
+// a snapshot of the group in O(1), for reports that should see the group at one point in time while it keeps changing.
+// the system must be created with snapshots. the caller should delete the snapshot.
+ReturnValue SystemManager::takeGroupSnapshot(int groupID, GroupSnapshot** group_snapshot) {
+    Group* group_ptr;
+    ReturnValue res = getGroupPtr(groupID, &group_ptr);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return group_ptr->takeSnapshot(group_snapshot);
+}
 
+// freezes the group for a read heavy phase (see Group::freeze). the group thaws by itself on its next update.
+ReturnValue SystemManager::freezeGroup(int groupID, FrozenScoreIndex score_index) {
+    Group* group_ptr;
+    ReturnValue res = getGroupPtr(groupID, &group_ptr);
+    if (res != MY_SUCCESS) {
+        return res;
+    }
+    return group_ptr->freeze(score_index);
+}
 
 
 
@@ -13,7 +13,8 @@ class SystemManager {
     ReturnValue addExistingPlayer(Player* player);
 
 public:
-    SystemManager(int groups_num, int scale);
+    SystemManager(int groups_num, int scale, int hist_threshold = DEFAULT_HIST_THRESHOLD,
+                  GroupTreeType tree_type = DEFAULT_GROUP_TREE, bool with_snapshots = DEFAULT_GROUP_SNAPSHOTS);
     ~SystemManager() = default;
 
     int getNumOfGroups() const { return num_of_groups; }
@@ -26,6 +27,8 @@ public:
     ReturnValue mergeGroups(int group1, int group2);
     ReturnValue calcAverageLeadPlayersLevelByGroup( int groupID, int m, double* calc_avg);
     ReturnValue getPlayersBoundByGroup(int groupID, int m, int score, int* lower_bound_players, int* higher_bound_players);
+    ReturnValue takeGroupSnapshot(int groupID, GroupSnapshot** group_snapshot);
+    ReturnValue freezeGroup(int groupID, FrozenScoreIndex score_index = DEFAULT_FROZEN_SCORE_INDEX);
 
 };
 
@@ -0,0 +1,121 @@
+#include "wavelet_matrix.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static void* allocateBlocks(size_t size) {
+    void* blocks = nullptr;
+#ifdef _WIN32
+    blocks = _aligned_malloc(size, WAVELET_BLOCK_ALIGNMENT);
+#else
+    if (posix_memalign(&blocks, WAVELET_BLOCK_ALIGNMENT, size) != 0) {
+        blocks = nullptr;
+    }
+#endif
+    if (!blocks) {
+        throw std::bad_alloc();
+    }
+    memset(blocks, 0, size);
+    return blocks;
+}
+
+static void freeBlocks(void* blocks) {
+#ifdef _WIN32
+    _aligned_free(blocks);
+#else
+    free(blocks);
+#endif
+}
+
+WaveletMatrix::WaveletMatrix(const int* values, int size, int max_value) : size(size), num_of_bits(1) {
+    while (num_of_bits < 31 && (max_value >> num_of_bits) != 0) {
+        num_of_bits++;
+    }
+    // a spare block at the end, so a rank at pos == size may read the block of pos
+    blocks_per_level = size / (64 * WAVELET_BLOCK_WORDS) + 1;
+    blocks = (Block*)allocateBlocks(sizeof(Block) * num_of_bits * blocks_per_level);
+    zeros = new int[num_of_bits];
+    int* level_values = new int[size];
+    int* next_values = new int[size];
+    if (!zeros || !level_values || !next_values) {
+        throw std::bad_alloc();
+    }
+    std::copy(values, values + size, level_values);
+
+    for (int level = 0; level < num_of_bits; level++) {
+        int bit = num_of_bits - 1 - level;
+        Block* level_blocks = blocks + (long)level * blocks_per_level;
+        for (int i = 0; i < size; i++) {
+            if ((level_values[i] >> bit) & 1) {
+                level_blocks[i / (64 * WAVELET_BLOCK_WORDS)].words[i / 64 % WAVELET_BLOCK_WORDS] |=
+                        (uint64_t)1 << (i % 64);
+            }
+        }
+        uint64_t ones = 0;
+        for (int block = 0; block < blocks_per_level; block++) {
+            level_blocks[block].ones_before = ones;
+            for (int word = 0; word < WAVELET_BLOCK_WORDS; word++) {
+                ones += __builtin_popcountll(level_blocks[block].words[word]);
+            }
+        }
+        zeros[level] = size - (int)ones;
+
+        // the next level orders the values by the bits so far: a stable partition by this bit
+        int num_of_zeros = 0;
+        int num_of_ones = 0;
+        for (int i = 0; i < size; i++) {
+            if ((level_values[i] >> bit) & 1) {
+                next_values[zeros[level] + num_of_ones++] = level_values[i];
+            }
+            else {
+                next_values[num_of_zeros++] = level_values[i];
+            }
+        }
+        std::swap(level_values, next_values);
+    }
+    delete[] level_values;
+    delete[] next_values;
+}
+
+WaveletMatrix::~WaveletMatrix() {
+    freeBlocks(blocks);
+    delete[] zeros;
+}
+
+// the amount of 1 bits of the level in positions [0, pos)
+int WaveletMatrix::rank1(int level, int pos) const {
+    const Block& block = blocks[(long)level * blocks_per_level + pos / (64 * WAVELET_BLOCK_WORDS)];
+    int word = pos / 64 % WAVELET_BLOCK_WORDS;
+    int ones = (int)block.ones_before;
+    for (int i = 0; i < word; i++) {
+        ones += __builtin_popcountll(block.words[i]);
+    }
+    if (pos % 64 != 0) {
+        ones += __builtin_popcountll(block.words[word] & (((uint64_t)1 << (pos % 64)) - 1));
+    }
+    return ones;
+}
+
+// follows the range of value (from position 0) and pos down the levels: a 1 bit maps a position to the ones after
+// the zeros of the next level, and a 0 bit to the zeros. at the bottom, the values between them are all value.
+int WaveletMatrix::rank(int value, int pos) const {
+    if (value < 0 || (value >> num_of_bits) != 0) {
+        return 0;
+    }
+    int start = 0;
+    for (int level = 0; level < num_of_bits; level++) {
+        if ((value >> (num_of_bits - 1 - level)) & 1) {
+            start = zeros[level] + rank1(level, start);
+            pos = zeros[level] + rank1(level, pos);
+        }
+        else {
+            start -= rank1(level, start);
+            pos -= rank1(level, pos);
+        }
+    }
+    return pos - start;
+}
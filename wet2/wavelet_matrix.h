@@ -0,0 +1,40 @@
+#ifndef WET2_WAVELET_MATRIX_H
+#define WET2_WAVELET_MATRIX_H
+
+#include <cstdint>
+
+// the 64 bit words of bits in a block of a bit vector. a block takes one cache line: the amount of 1 bits before it,
+// and its words.
+#define WAVELET_BLOCK_WORDS 7
+#define WAVELET_BLOCK_ALIGNMENT 64
+
+// a static wavelet matrix over a sequence of values in [0, max_value]: a bit vector per bit of the values (from the
+// highest bit down), where every level holds the bits of the values ordered by the bits above it (stably, the values
+// with a 0 bit first). it counts the occurrences of a value in a prefix of the sequence in O(log(max_value)), with
+// about size*log(max_value) bits, plus a rank count per block of WAVELET_BLOCK_WORDS words, in the cache line of
+// the block, so counting the 1 bits before a position reads a single cache line.
+class WaveletMatrix {
+    struct Block {
+        uint64_t ones_before;
+        uint64_t words[WAVELET_BLOCK_WORDS];
+    };
+
+    int size;
+    int num_of_bits;
+    int blocks_per_level;
+    Block* blocks;           // the bit vectors of the levels, blocks_per_level blocks each, on cache line boundaries
+    int* zeros;              // the amount of 0 bits of each level
+
+    int rank1(int level, int pos) const;
+
+public:
+    WaveletMatrix(const int* values, int size, int max_value);
+    ~WaveletMatrix();
+    WaveletMatrix(const WaveletMatrix& other) = delete;
+    WaveletMatrix& operator=(const WaveletMatrix& other) = delete;
+
+    // the amount of values equal to value in positions [0, pos)
+    int rank(int value, int pos) const;
+};
+
+#endif //WET2_WAVELET_MATRIX_H